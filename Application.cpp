@@ -34,11 +34,11 @@ int main(int argc, char *argv[]) {
 	// Create a new application object
 	Application *app = new Application(argv[1]);
 	// Call the run function
-	app->run();
+	int status = app->run();
 	// When done delete the application object
 	delete(app);
 
-	return SUCCESS;
+	return status;
 }
 
 /**
@@ -47,11 +47,53 @@ int main(int argc, char *argv[]) {
 Application::Application(char *infile) {
 	int i;
 	par = new Params();
-	srand (time(NULL));
 	par->setparams(infile);
+	srand (par->SEED);
+	cluster = NULL;
+	pool = NULL;
+	testsDue = 0;
+	failedAt.assign(par->EN_GPSZ, -1);
+	convergedAt.assign(par->EN_GPSZ, -1);
+	detectedAt.assign(par->EN_GPSZ, -1);
+	knownBy.assign(par->EN_GPSZ, 0);
+	started = 0;
+	alive = 0;
+	falseRemovals = 0;
+	if ( par->PROCESSES > 1 ) {
+		// The launcher only forks the workers and merges their logs, it hosts no nodes
+		cluster = new Cluster(par);
+		if ( !cluster->start() ) {
+			log = NULL;
+			en = NULL;
+			en1 = NULL;
+			mp1 = NULL;
+			mp2 = NULL;
+			return;
+		}
+	}
 	log = new Log(par);
-	en = new EmulNet(par);
-	en1 = new EmulNet(par);
+	if ( cluster != NULL ) {
+		en = new ShmNet(par, cluster, 0);
+		en1 = new ShmNet(par, cluster, 1);
+	}
+	else if ( par->TRANSPORT == UDP_TRANSPORT ) {
+		// MP1 and MP2 each get their own block of ports
+		en = new UdpNet(par, par->UDP_PORT_BASE);
+		en1 = new UdpNet(par, par->UDP_PORT_BASE + par->EN_GPSZ + 1);
+	}
+	else {
+		en = new EmulNet(par);
+		en1 = new EmulNet(par);
+	}
+	if ( par->THREADS > 1 ) {
+		if ( cluster == NULL && par->TRANSPORT == EMUL_TRANSPORT ) {
+			pool = new ThreadPool(par->THREADS);
+			nodeLogs.resize(par->EN_GPSZ);
+		}
+		else {
+			cout<<"THREADS needs the emulated network in a single process, running the nodes on one thread"<<endl;
+		}
+	}
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
 	mp2 = (MP2Node **) malloc(par->EN_GPSZ * sizeof(MP2Node *));
 
@@ -67,10 +109,31 @@ Application::Application(char *infile) {
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
 		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
 		mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
-		log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
+		if ( owns(i) ) {
+			log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+			log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
+		}
 		delete addressOfMemberNode;
 	}
+
+	if ( par->SCHEDULER == EVENT_SCHEDULER ) {
+		if ( cluster != NULL || par->TRANSPORT != EMUL_TRANSPORT ) {
+			cout<<"SCHEDULER: EVENT needs the emulated network in a single process, visiting every tick"<<endl;
+			par->SCHEDULER = TICK_SCHEDULER;
+		}
+		else {
+			due.resize(par->EN_GPSZ);
+			for ( i = 0; i < par->EN_GPSZ; i++ ) {
+				schedule((int)(par->STEP_RATE*i), i, EV_START);
+			}
+			// every tick on which a test acts
+			int testTimes[] = {INSERT_TIME, TEST_TIME, TEST_TIME + FIRST_FAIL_TIME, TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME,
+					TEST_TIME + FIRST_FAIL_TIME + 2 * STABILIZE_TIME, TEST_TIME + FIRST_FAIL_TIME + 2 * STABILIZE_TIME + LAST_FAIL_TIME};
+			for ( unsigned int t = 0; t < sizeof(testTimes)/sizeof(testTimes[0]); t++ ) {
+				schedule(testTimes[t], -1, EV_TEST);
+			}
+		}
+	}
 }
 
 /**
@@ -80,12 +143,16 @@ Application::~Application() {
 	delete log;
 	delete en;
 	delete en1;
-	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
-		delete mp1[i];
-		delete mp2[i];
+	if ( mp1 != NULL ) {
+		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+			delete mp1[i];
+			delete mp2[i];
+		}
 	}
 	free(mp1);
 	free(mp2);
+	delete pool;
+	delete cluster;
 	delete par;
 }
 
@@ -100,12 +167,19 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
 
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
+	if ( cluster != NULL && cluster->getWorker() < 0 ) {
+		return cluster->supervise();
+	}
+	srand(par->SEED);
+
+	// As time runs along; the event scheduler jumps straight to the next tick with something due
+	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; par->globaltime = nextEventTime() ) {
+		popEvents();
+
 		// Run the membership protocol
 		mp1Run();
+		trackMembership();
 
 		// Wait for all nodes to join
 		if ( par->allNodesJoined == nodeCount && !allNodesJoined ) {
@@ -118,14 +192,27 @@ int Application::run()
 		}
 		// Fail some nodes
 		//fail();
+
+		if ( cluster != NULL ) {
+			// Everything sent in this tick is in the rings before any worker starts the next one
+			cluster->barrier();
+			if ( cluster->getWorker() == 0 ) {
+				cluster->clearCmds();
+			}
+		}
 	}
 
+	logQuorumLatency();
+	logMembershipStats();
+
 	// Clean up
 	en->ENcleanup();
 	en1->ENcleanup();
 
 	for(i=0;i<=par->EN_GPSZ-1;i++) {
-		 mp1[i]->finishUpThisNode();
+		if ( owns(i) ) {
+			mp1[i]->finishUpThisNode();
+		}
 	}
 
 	return SUCCESS;
@@ -138,6 +225,7 @@ int Application::run()
  */
 void Application::mp1Run() {
 	int i;
+	vector<int> nodes;
 
 	// For all the nodes in the system
 	for( i = 0; i <= par->EN_GPSZ-1; i++) {
@@ -145,30 +233,48 @@ void Application::mp1Run() {
 		/*
 		 * Receive messages from the network and queue them in the membership protocol queue
 		 */
-		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// Receive messages from the network and queue them
-			mp1[i]->recvLoop();
+		if( owns(i) && par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) &&
+				(!eventDriven() || en->ENhasMail(&mp1[i]->getMemberNode()->addr)) ) {
+			nodes.push_back(i);
 		}
 
 	}
+	runPhase(nodes, en, [&](int i) {
+		// Receive messages from the network and queue them
+		mp1[i]->recvLoop();
+	});
 
 	// For all the nodes in the system
+	nodes.clear();
 	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
 
 		/*
 		 * Introduce nodes into the distributed system
 		 */
 		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
-			// introduce the ith node into the system at time STEPRATE*i
-			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+			if ( owns(i) ) {
+				nodes.push_back(i);
+			}
+			// Every worker counts every node, so that they all see the group complete at the same tick
 			nodeCount += i;
 		}
 
 		/*
 		 * Handle all the messages in your queue and send heartbeats
 		 */
-		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+		else if( owns(i) && par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) &&
+				(!eventDriven() || (due[i] & EV_MP1_TIMER) || !mp1[i]->getMemberNode()->mp1q.empty()) ) {
+			// A node outside the group only has work when a message came in
+			nodes.push_back(i);
+		}
+
+	}
+	runPhase(nodes, en, [&](int i) {
+		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+			// introduce the ith node into the system at time STEPRATE*i
+			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+		}
+		else {
 			// handle messages and send heartbeats
 			mp1[i]->nodeLoop();
 			#ifdef DEBUGLOG
@@ -177,7 +283,23 @@ void Application::mp1Run() {
 			}
 			#endif
 		}
+	});
 
+	for ( unsigned int k = 0; k < nodes.size(); k++ ) {
+		i = nodes[k];
+		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+		}
+		// Gossip rounds and deadlines of a node in the group; its heartbeat follows from the clock
+		if ( mp1[i]->getMemberNode()->inGroup && !mp1[i]->getMemberNode()->bFailed ) {
+			int next = mp1[i]->nextTimer();
+			#ifdef DEBUGLOG
+			if ( i == 0 ) {
+				next = min(next, (par->getcurrtime() / 500 + 1) * 500);
+			}
+			#endif
+			schedule(next, i, EV_MP1_TIMER);
+		}
 	}
 }
 
@@ -191,33 +313,85 @@ void Application::mp1Run() {
  */
 void Application::mp2Run() {
 	int i;
+	vector<int> nodes;
+	vector<int> active;
 
 	// For all the nodes in the system
 	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+		if ( owns(i) && par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
+			nodes.push_back(i);
+		}
+	}
 
-		/*
-		 * 1) Update the ring
-		 * 2) Receive messages from the network and queue them in the KV store queue
-		 */
-		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
-			if ( mp2[i]->getMemberNode()->inited && mp2[i]->getMemberNode()->inGroup ) {
-				// Step 1
-				mp2[i]->updateRing();
+	/*
+	 * 1) Update the ring
+	 * 2) Receive messages from the network and queue them in the KV store queue
+	 *
+	 * All the rings are updated before any node receives, so whatever the
+	 * stabilization sends reaches every node at the same point.
+	 */
+	if ( eventDriven() ) {
+		// Only MP1 moves the membership version, most ticks leave every ring as it is
+		for ( unsigned int k = 0; k < nodes.size(); k++ ) {
+			if ( !mp2[nodes[k]]->ringCurrent() ) {
+				active.push_back(nodes[k]);
 			}
-			// Step 2
-			mp2[i]->recvLoop();
 		}
 	}
+	runPhase(eventDriven() ? active : nodes, en1, [&](int i) {
+		if ( mp2[i]->getMemberNode()->inited && mp2[i]->getMemberNode()->inGroup ) {
+			mp2[i]->updateRing();
+		}
+	});
+	if ( eventDriven() ) {
+		active.clear();
+		for ( unsigned int k = 0; k < nodes.size(); k++ ) {
+			if ( en1->ENhasMail(&mp2[nodes[k]]->getMemberNode()->addr) ) {
+				active.push_back(nodes[k]);
+			}
+		}
+	}
+	runPhase(eventDriven() ? active : nodes, en1, [&](int i) {
+		mp2[i]->recvLoop();
+	});
 
 	/**
 	 * Handle messages from the queue and update the DHT
 	 */
-	for ( i = par->EN_GPSZ-1; i >= 0; i-- ) {
-		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
-			mp2[i]->checkMessages();
+	reverse(nodes.begin(), nodes.end());
+	if ( eventDriven() ) {
+		// Only a message or a quorum deadline gives a node something to check
+		active.clear();
+		for ( unsigned int k = 0; k < nodes.size(); k++ ) {
+			i = nodes[k];
+			if ( !mp2[i]->getMemberNode()->mp2q.empty() || (due[i] & EV_MP2_DEADLINE) ) {
+				active.push_back(i);
+			}
 		}
 	}
+	runPhase(eventDriven() ? active : nodes, en1, [&](int i) {
+		mp2[i]->checkMessages();
+	});
 
+	/**
+	 * Run the tests. In cluster mode worker 0 drives them and every worker
+	 * carries out the resulting commands for its own nodes.
+	 */
+	if ( isDriver() && (!eventDriven() || testsDue) ) {
+		testRun();
+	}
+	if ( cluster != NULL ) {
+		cluster->barrier();
+		applyCommands();
+	}
+}
+
+/**
+ * FUNCTION NAME: testRun
+ *
+ * DESCRIPTION: Drives the CRUD tests: inserts the test key value pairs and runs the configured test
+ */
+void Application::testRun() {
 	/**
 	 * Insert a set of test key value pairs into the system
 	 */
@@ -364,6 +538,434 @@ void Application::fail() {
 
 }
 
+/**
+ * FUNCTION NAME: logQuorumLatency
+ *
+ * DESCRIPTION: Writes the distribution of coordinator quorum latencies, in ticks, to the stats log
+ */
+void Application::logQuorumLatency() {
+	vector<int> latencies;
+	int timeouts = 0;
+	int first = -1;
+
+	// In cluster mode each worker reports on its own nodes
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( !owns(i) ) {
+			continue;
+		}
+		if ( first < 0 ) {
+			first = i;
+		}
+		vector<int> &nodeLatencies = mp2[i]->getQuorumLatencies();
+		latencies.insert(latencies.end(), nodeLatencies.begin(), nodeLatencies.end());
+		timeouts += mp2[i]->getQuorumTimeouts();
+	}
+	if ( latencies.empty() ) {
+		return;
+	}
+
+	sort(latencies.begin(), latencies.end());
+	int n = latencies.size();
+	log->LOG(&mp2[first]->getMemberNode()->addr, "#STATSLOG# quorum latency: ops %d timeouts %d p50 %d p90 %d p99 %d max %d",
+			n, timeouts, latencies[(n - 1) * 50 / 100], latencies[(n - 1) * 90 / 100], latencies[(n - 1) * 99 / 100], latencies[n - 1]);
+}
+
+/**
+ * FUNCTION NAME: trackMembership
+ *
+ * DESCRIPTION: Follows how fast the membership lists converge on a new node and drop a failed
+ * 				one, and counts the alive nodes some list dropped. Works off the ids each list
+ * 				added and removed since the last call, so a tick costs the list changes plus
+ * 				one pass over the counts. Needs every list, so only a single process keeps track.
+ */
+void Application::trackMembership() {
+	int now = par->getcurrtime();
+	int i, j;
+
+	for ( ; started < par->EN_GPSZ && now >= (int)(par->STEP_RATE*started); started++ ) {
+		if ( failedAt[started] < 0 ) {
+			alive++;
+		}
+	}
+	for ( i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( !owns(i) ) {
+			continue;
+		}
+		bool counted = cluster == NULL && !mp1[i]->getMemberNode()->bFailed;
+		vector<int> &added = mp1[i]->getAddedIds();
+		vector<int> &removed = mp1[i]->getRemovedIds();
+		for ( unsigned int k = 0; k < added.size() && counted; k++ ) {
+			if ( added[k] >= 1 && added[k] <= par->EN_GPSZ ) {
+				knownBy[added[k] - 1]++;
+			}
+		}
+		for ( unsigned int k = 0; k < removed.size() && cluster == NULL; k++ ) {
+			if ( removed[k] >= 1 && removed[k] <= par->EN_GPSZ ) {
+				if ( counted ) {
+					knownBy[removed[k] - 1]--;
+				}
+				if ( failedAt[removed[k] - 1] < 0 ) {
+					falseRemovals++;
+				}
+			}
+		}
+		added.clear();
+		removed.clear();
+	}
+	if ( cluster != NULL ) {
+		return;
+	}
+
+	for ( j = 0; j < started; j++ ) {
+		if ( convergedAt[j] < 0 && failedAt[j] < 0 && knownBy[j] == alive ) {
+			convergedAt[j] = now;
+		}
+		if ( failedAt[j] >= 0 && detectedAt[j] < 0 && knownBy[j] == 0 ) {
+			detectedAt[j] = now;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: logMembershipStats
+ *
+ * DESCRIPTION: Logs the MP1 traffic, the join convergence and the failure detection times to stats.log
+ */
+void Application::logMembershipStats() {
+	long messages = 0;
+	long bytes = 0;
+	int joined = 0, joinSum = 0, joinMax = 0;
+	int failed = 0, detected = 0, detectSum = 0, detectMax = 0;
+	int stabilizations = 0;
+	long stabilizationMessages = 0;
+	long digests = 0, digestsMatched = 0;
+
+	if ( cluster != NULL ) {
+		return;
+	}
+
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		messages += mp1[i]->getSentMessages();
+		bytes += mp1[i]->getSentBytes();
+		stabilizations += mp2[i]->getStabilizations();
+		stabilizationMessages += mp2[i]->getStabilizationMessages();
+		digests += mp1[i]->getDigestsReceived();
+		digestsMatched += mp1[i]->getDigestsMatched();
+		if ( convergedAt[i] >= 0 ) {
+			int ticks = convergedAt[i] - (int)(par->STEP_RATE*i);
+			joined++;
+			joinSum += ticks;
+			joinMax = max(joinMax, ticks);
+		}
+		if ( failedAt[i] >= 0 ) {
+			failed++;
+			if ( detectedAt[i] >= 0 ) {
+				int ticks = detectedAt[i] - failedAt[i];
+				detected++;
+				detectSum += ticks;
+				detectMax = max(detectMax, ticks);
+			}
+		}
+	}
+
+	Address *addr = &mp1[0]->getMemberNode()->addr;
+	if ( par->VIEW == HYPARVIEW_VIEW ) {
+		log->LOG(addr, "#STATSLOG# membership: view HYPARVIEW active %d passive %d shuffle %d keepalive %d ring %d messages %ld bytes %ld",
+				par->VIEW_ACTIVE, par->VIEW_PASSIVE, par->VIEW_SHUFFLE, par->VIEW_KEEPALIVE, par->VIEW_RING, messages, bytes);
+	}
+	else if ( par->DETECTOR == SWIM_DETECTOR ) {
+		log->LOG(addr, "#STATSLOG# membership: detector SWIM period %d k %d suspect %d messages %ld bytes %ld",
+				par->SWIM_PERIOD, par->SWIM_K, par->SWIM_SUSPECT, messages, bytes);
+	}
+	else if ( par->DETECTOR == RING_DETECTOR ) {
+		log->LOG(addr, "#STATSLOG# membership: detector RING k %d timeout %d suspect %d messages %ld bytes %ld",
+				par->RING_K, par->RING_TIMEOUT, par->SWIM_SUSPECT, messages, bytes);
+	}
+	else if ( par->DETECTOR == PHI_DETECTOR ) {
+		log->LOG(addr, "#STATSLOG# membership: detector PHI threshold %.1f window %d gossip %s fanout %d period %d messages %ld bytes %ld",
+				par->PHI_THRESHOLD, par->PHI_WINDOW, par->GOSSIP == FANOUT_GOSSIP ? "FANOUT" : "ALL", par->GOSSIP_FANOUT,
+				par->GOSSIP_PERIOD, messages, bytes);
+	}
+	else {
+		log->LOG(addr, "#STATSLOG# membership: gossip %s fanout %d period %d messages %ld bytes %ld",
+				par->GOSSIP == FANOUT_GOSSIP ? "FANOUT" : "ALL", par->GOSSIP_FANOUT, par->GOSSIP_PERIOD, messages, bytes);
+	}
+	if ( par->GOSSIP_DIGEST > 0 ) {
+		log->LOG(addr, "#STATSLOG# membership digests: epoch %d matched %ld/%ld", par->GOSSIP_DIGEST, digestsMatched, digests);
+	}
+	log->LOG(addr, "#STATSLOG# membership convergence: joined %d/%d avg %.1f max %d ticks",
+			joined, par->EN_GPSZ, joined ? (double)joinSum / joined : 0.0, joinMax);
+	log->LOG(addr, "#STATSLOG# failure detection: detected %d/%d avg %.1f max %d ticks (TREMOVE %d) false removals %d",
+			detected, failed, detected ? (double)detectSum / detected : 0.0, detectMax, TREMOVE, falseRemovals);
+	log->LOG(addr, "#STATSLOG# re-replication: stabilizations %d messages %ld", stabilizations, stabilizationMessages);
+}
+
+/**
+ * FUNCTION NAME: runPhase
+ *
+ * DESCRIPTION: Runs step for each of the nodes, in that order. The steps of one phase must
+ * 				not depend on each other. With a thread pool they run in parallel: their sends
+ * 				are staged and their log lines captured, then both are committed in the order
+ * 				of nodes, which gives exactly what the serial loop writes and sends.
+ */
+void Application::runPhase(vector<int> &nodes, EmulNet *net, function<void(int)> step) {
+	unsigned int k;
+
+	if ( pool == NULL ) {
+		for ( k = 0; k < nodes.size(); k++ ) {
+			step(nodes[k]);
+		}
+		return;
+	}
+
+	net->ENbeginPhase();
+	pool->run(nodes.size(), [&](int k) {
+		Log::beginCapture(&nodeLogs[nodes[k]]);
+		step(nodes[k]);
+		Log::endCapture();
+	});
+	net->ENendPhase();
+
+	for ( k = 0; k < nodes.size(); k++ ) {
+		log->flush(nodeLogs[nodes[k]]);
+		net->ENcommit(&mp1[nodes[k]]->getMemberNode()->addr);
+	}
+}
+
+/**
+ * FUNCTION NAME: eventDriven
+ *
+ * DESCRIPTION: Whether only the nodes with something due are visited, see SCHEDULER
+ */
+bool Application::eventDriven() {
+	return par->SCHEDULER == EVENT_SCHEDULER;
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Queues an event for the event scheduler; does nothing when every tick is visited
+ */
+void Application::schedule(int time, int node, int type) {
+	if ( !eventDriven() ) {
+		return;
+	}
+	SimEvent event;
+	event.time = time;
+	event.node = node;
+	event.type = type;
+	events.push(event);
+}
+
+/**
+ * FUNCTION NAME: popEvents
+ *
+ * DESCRIPTION: Collects the events due at the current tick into due and testsDue
+ */
+void Application::popEvents() {
+	if ( !eventDriven() ) {
+		return;
+	}
+	fill(due.begin(), due.end(), 0);
+	testsDue = 0;
+	while ( !events.empty() && events.top().time <= par->getcurrtime() ) {
+		SimEvent event = events.top();
+		events.pop();
+		if ( event.node < 0 ) {
+			testsDue |= event.type;
+		}
+		else {
+			due[event.node] |= event.type;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: nextEventTime
+ *
+ * DESCRIPTION: The tick to run after the current one. The event scheduler skips ticks in which
+ * 				no event is due, no message is waiting for an alive node and none reaches a mailbox.
+ */
+int Application::nextEventTime() {
+	int now = par->getcurrtime();
+	int next;
+
+	if ( !eventDriven() ) {
+		return now + 1;
+	}
+
+	next = events.empty() ? TOTAL_RUNNING_TIME : events.top().time;
+	if ( next > now + 1 ) {
+		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+			Member *member = mp1[i]->getMemberNode();
+			if ( now >= (int)(par->STEP_RATE*i) && !member->bFailed && (en->ENhasMail(&member->addr) || en1->ENhasMail(&member->addr)) ) {
+				return now + 1;
+			}
+		}
+		next = min(next, en->ENnextDelivery());
+		next = min(next, en1->ENnextDelivery());
+	}
+	return max(now + 1, min(next, TOTAL_RUNNING_TIME));
+}
+
+/**
+ * FUNCTION NAME: owns
+ *
+ * DESCRIPTION: Whether node i runs in this process
+ */
+bool Application::owns(int i) {
+	return cluster == NULL || cluster->owns(i);
+}
+
+/**
+ * FUNCTION NAME: isDriver
+ *
+ * DESCRIPTION: Whether this process runs the tests
+ */
+bool Application::isDriver() {
+	return cluster == NULL || cluster->getWorker() == 0;
+}
+
+/**
+ * FUNCTION NAME: ringOf
+ *
+ * DESCRIPTION: Node whose ring answers the tests' replica lookups on behalf of node number.
+ * 				In cluster mode only this worker's nodes keep their ring up to date,
+ * 				so another worker's node is stood in for by an alive node of this one.
+ */
+MP2Node *Application::ringOf(int number) {
+	int i;
+
+	if ( owns(number) ) {
+		return mp2[number];
+	}
+	for ( i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( owns(i) && !mp2[i]->getMemberNode()->bFailed ) {
+			return mp2[i];
+		}
+	}
+	for ( i = 0; !owns(i); i++ );
+	return mp2[i];
+}
+
+/**
+ * FUNCTION NAME: failNode
+ *
+ * DESCRIPTION: Fails node i in both protocols
+ */
+void Application::failNode(int i) {
+	failedAt[i] = par->getcurrtime();
+	if ( cluster == NULL && i < started ) {
+		// a failed node's list stops counting
+		vector<MemberListEntry> &list = mp1[i]->getMemberNode()->memberList;
+		for ( unsigned int k = 0; k < list.size(); k++ ) {
+			if ( list[k].id >= 1 && list[k].id <= par->EN_GPSZ ) {
+				knownBy[list[k].id - 1]--;
+			}
+		}
+		alive--;
+	}
+	mp2[i]->getMemberNode()->bFailed = true;
+	mp1[i]->getMemberNode()->bFailed = true;
+	if ( cluster != NULL ) {
+		cluster->post(CMD_FAIL, i, "", "");
+	}
+}
+
+/**
+ * FUNCTION NAME: issueCreate
+ *
+ * DESCRIPTION: Has node number coordinate a create
+ */
+void Application::issueCreate(int number, string key, string value) {
+	if ( cluster != NULL ) {
+		cluster->post(CMD_CREATE, number, key, value);
+	}
+	else {
+		mp2[number]->clientCreate(key, value);
+		schedule(par->getcurrtime() + TIME_OUT + 1, number, EV_MP2_DEADLINE);
+	}
+}
+
+/**
+ * FUNCTION NAME: issueRead
+ *
+ * DESCRIPTION: Has node number coordinate a read
+ */
+void Application::issueRead(int number, string key) {
+	if ( cluster != NULL ) {
+		cluster->post(CMD_READ, number, key, "");
+	}
+	else {
+		mp2[number]->clientRead(key);
+		schedule(par->getcurrtime() + TIME_OUT + 1, number, EV_MP2_DEADLINE);
+	}
+}
+
+/**
+ * FUNCTION NAME: issueUpdate
+ *
+ * DESCRIPTION: Has node number coordinate an update
+ */
+void Application::issueUpdate(int number, string key, string value) {
+	if ( cluster != NULL ) {
+		cluster->post(CMD_UPDATE, number, key, value);
+	}
+	else {
+		mp2[number]->clientUpdate(key, value);
+		schedule(par->getcurrtime() + TIME_OUT + 1, number, EV_MP2_DEADLINE);
+	}
+}
+
+/**
+ * FUNCTION NAME: issueDelete
+ *
+ * DESCRIPTION: Has node number coordinate a delete
+ */
+void Application::issueDelete(int number, string key) {
+	if ( cluster != NULL ) {
+		cluster->post(CMD_DELETE, number, key, "");
+	}
+	else {
+		mp2[number]->clientDelete(key);
+		schedule(par->getcurrtime() + TIME_OUT + 1, number, EV_MP2_DEADLINE);
+	}
+}
+
+/**
+ * FUNCTION NAME: applyCommands
+ *
+ * DESCRIPTION: Carries out the driver's commands of this tick. Failures are applied to
+ * 				every worker's copy of the node, client operations only by its owner.
+ */
+void Application::applyCommands() {
+	for ( int c = 0; c < cluster->getNumCmds(); c++ ) {
+		cluster_cmd *cmd = cluster->getCmd(c);
+		int i = cmd->node;
+
+		if ( cmd->type == CMD_FAIL ) {
+			mp2[i]->getMemberNode()->bFailed = true;
+			mp1[i]->getMemberNode()->bFailed = true;
+		}
+		else if ( owns(i) ) {
+			switch ( cmd->type ) {
+				case CMD_CREATE:
+					mp2[i]->clientCreate(cmd->key, cmd->value);
+					break;
+				case CMD_READ:
+					mp2[i]->clientRead(cmd->key);
+					break;
+				case CMD_UPDATE:
+					mp2[i]->clientUpdate(cmd->key, cmd->value);
+					break;
+				case CMD_DELETE:
+					mp2[i]->clientDelete(cmd->key);
+					break;
+			}
+		}
+	}
+}
+
 /**
  * FUNCTION NAME: getjoinaddr
  *
@@ -398,7 +1000,7 @@ int Application::findARandomNodeThatIsAlive() {
  * DESCRIPTION: Init NUMBER_OF_INSERTS test KV pairs in the map
  */
 void Application::initTestKVPairs() {
-	srand(time(NULL));
+	srand(par->SEED);
 	int i;
 	string key;
 	key.clear();
@@ -433,7 +1035,7 @@ void Application::insertTestKVPairs() {
 
 		// Step 2. Issue a create operation
 		log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientCreate(it->first, it->second);
+		issueCreate(number, it->first, it->second);
 	}
 
 	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
@@ -459,7 +1061,7 @@ void Application::deleteTest() {
 
 		// Step 1.b. Issue a delete operation
 		log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientDelete(it->first);
+		issueDelete(number, it->first);
 	}
 
 	/**
@@ -472,7 +1074,7 @@ void Application::deleteTest() {
 
 	// Step 2.b. Issue a delete operation
 	log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
-	mp2[number]->clientDelete(invalidKey);
+	issueDelete(number, invalidKey);
 }
 
 /**
@@ -501,7 +1103,7 @@ void Application::readTest() {
 		// Step 1.b Do a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientRead(it->first);
+		issueRead(number, it->first);
 	}
 
 	/** end of test1 **/
@@ -515,7 +1117,7 @@ void Application::readTest() {
 
 		// Step 2.b Find the replicas of this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = ringOf(number)->findNodes(it->first);
 		// if less than quorum replicas are found then exit
 		if ( replicas.size() < (RF-1) ) {
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
@@ -544,8 +1146,7 @@ void Application::readTest() {
 		}
 		if ( failedOneNode ) {
 			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-			mp2[nodeToFail]->getMemberNode()->bFailed = true;
-			mp1[nodeToFail]->getMemberNode()->bFailed = true;
+			failNode(nodeToFail);
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
@@ -560,7 +1161,7 @@ void Application::readTest() {
 		// Step 2.d Issue a read
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientRead(it->first);
+		issueRead(number, it->first);
 
 		failedOneNode = false;
 	}
@@ -582,7 +1183,7 @@ void Application::readTest() {
 
 			// Get the keys replicas
 			replicas.clear();
-			replicas = mp2[number]->findNodes(it->first);
+			replicas = ringOf(number)->findNodes(it->first);
 
 			// Step 3.b. Fail two replicas
 			//cout<<"REPLICAS SIZE: "<<replicas.size();
@@ -618,8 +1219,7 @@ void Application::readTest() {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
 					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
+					failNode(nodesToFail.at(i));
 					cout<<endl<<"Failed a replica node"<<endl;
 				}
 			}
@@ -637,7 +1237,7 @@ void Application::readTest() {
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should fail since at least quorum nodes are not alive
-			mp2[number]->clientRead(it->first);
+			issueRead(number, it->first);
 		}
 
 		/**
@@ -650,7 +1250,7 @@ void Application::readTest() {
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should be successful
-			mp2[number]->clientRead(it->first);
+			issueRead(number, it->first);
 		}
 	}
 
@@ -665,7 +1265,7 @@ void Application::readTest() {
 
 		// Step 4.b Find a non - replica for this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = ringOf(number)->findNodes(it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
 				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
@@ -673,8 +1273,7 @@ void Application::readTest() {
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
 					// Step 4.c Fail a non-replica node
 					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[i]->getMemberNode()->bFailed = true;
-					mp1[i]->getMemberNode()->bFailed = true;
+					failNode(i);
 					failedOneNode = true;
 					cout<<endl<<"Failed a non-replica node"<<endl;
 					break;
@@ -694,7 +1293,7 @@ void Application::readTest() {
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientRead(it->first);
+		issueRead(number, it->first);
 	}
 
 	/** end of test 4 **/
@@ -712,7 +1311,7 @@ void Application::readTest() {
 		cout<<endl<<"Reading an invalid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientRead(invalidKey);
+		issueRead(number, invalidKey);
 	}
 
 	/** end of test 5 **/
@@ -746,7 +1345,7 @@ void Application::updateTest() {
 		// Step 1.b Do a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
-		mp2[number]->clientUpdate(it->first, newValue);
+		issueUpdate(number, it->first, newValue);
 	}
 
 	/** end of test 1 **/
@@ -760,7 +1359,7 @@ void Application::updateTest() {
 
 		// Step 2.b Find the replicas of this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = ringOf(number)->findNodes(it->first);
 		// if quorum replicas are not found then exit
 		if ( replicas.size() < RF-1 ) {
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
@@ -789,8 +1388,7 @@ void Application::updateTest() {
 		}
 		if ( failedOneNode ) {
 			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-			mp2[nodeToFail]->getMemberNode()->bFailed = true;
-			mp1[nodeToFail]->getMemberNode()->bFailed = true;
+			failNode(nodeToFail);
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
@@ -805,7 +1403,7 @@ void Application::updateTest() {
 		// Step 2.d Issue a update
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
-		mp2[number]->clientUpdate(it->first, newValue);
+		issueUpdate(number, it->first, newValue);
 
 		failedOneNode = false;
 	}
@@ -827,7 +1425,7 @@ void Application::updateTest() {
 
 			// Get the keys replicas
 			replicas.clear();
-			replicas = mp2[number]->findNodes(it->first);
+			replicas = ringOf(number)->findNodes(it->first);
 
 			// Step 3.b. Fail two replicas
 			if ( replicas.size() > 2 ) {
@@ -861,8 +1459,7 @@ void Application::updateTest() {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
 					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
+					failNode(nodesToFail.at(i));
 					cout<<endl<<"Failed a replica node"<<endl;
 				}
 			}
@@ -879,7 +1476,7 @@ void Application::updateTest() {
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should fail since at least quorum nodes are not alive
-			mp2[number]->clientUpdate(it->first, newValue);
+			issueUpdate(number, it->first, newValue);
 		}
 
 		/**
@@ -892,7 +1489,7 @@ void Application::updateTest() {
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should be successful
-			mp2[number]->clientUpdate(it->first, newValue);
+			issueUpdate(number, it->first, newValue);
 		}
 	}
 
@@ -907,7 +1504,7 @@ void Application::updateTest() {
 
 		// Step 4.b Find a non - replica for this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = ringOf(number)->findNodes(it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
 				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
@@ -915,8 +1512,7 @@ void Application::updateTest() {
 					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
 					// Step 4.c Fail a non-replica node
 					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[i]->getMemberNode()->bFailed = true;
-					mp1[i]->getMemberNode()->bFailed = true;
+					failNode(i);
 					failedOneNode = true;
 					cout<<endl<<"Failed a non-replica node"<<endl;
 					break;
@@ -937,7 +1533,7 @@ void Application::updateTest() {
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientUpdate(it->first, newValue);
+		issueUpdate(number, it->first, newValue);
 	}
 
 	/** end of test 4 **/
@@ -956,7 +1552,7 @@ void Application::updateTest() {
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", invalidKey.c_str(), invalidValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientUpdate(invalidKey, invalidValue);
+		issueUpdate(number, invalidKey, invalidValue);
 	}
 
 	/** end of test 5 **/
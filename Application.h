@@ -13,6 +13,9 @@
 #include "Params.h"
 #include "Member.h"
 #include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
+#include "ThreadPool.h"
 #include "Queue.h"
 #include "MP2Node.h"
 #include "Node.h"
@@ -41,6 +44,27 @@ static const char alphanum[] =
 #define NUMBER_OF_INSERTS 100
 #define KEY_LENGTH 5
 
+/**
+ * Event types of the event scheduler, bit flags so that the events of a tick
+ * can be collected per node
+ */
+enum eventTYPE { EV_START = 1, EV_MP1_TIMER = 2, EV_MP2_DEADLINE = 4, EV_TEST = 8 };
+
+/**
+ * Struct Name: SimEvent
+ *
+ * DESCRIPTION: Something due at a tick: a node to start, a node's periodic membership work,
+ * 				a coordinator's quorum deadline, or a test step (node -1)
+ */
+typedef struct SimEvent {
+	int time;
+	int node;
+	int type;
+	bool operator >(const SimEvent &another) const {
+		return time > another.time || (time == another.time && node > another.node);
+	}
+}SimEvent;
+
 /**
  * CLASS NAME: Application
  *
@@ -58,6 +82,27 @@ private:
 	MP2Node **mp2;
 	Params *par;
 	map<string, string> testKVPairs;
+	// worker processes of the cluster mode, NULL when everything runs in this process
+	Cluster *cluster;
+	// runs the nodes of a phase in parallel, NULL to run them on this thread
+	ThreadPool *pool;
+	// log lines of each node captured during a parallel phase
+	vector< vector<LogRecord> > nodeLogs;
+	// pending events of the event scheduler, earliest first
+	priority_queue< SimEvent, vector<SimEvent>, greater<SimEvent> > events;
+	// event flags due at the current tick, per node, and for the tests
+	vector<int> due;
+	int testsDue;
+	// membership tracking, per node: tick it failed, tick every alive node knew it, tick none did
+	vector<int> failedAt;
+	vector<int> convergedAt;
+	vector<int> detectedAt;
+	// per node, how many alive lists hold it; nodes started so far and how many of them are alive
+	vector<int> knownBy;
+	int started;
+	int alive;
+	// alive nodes dropped from some list
+	int falseRemovals;
 public:
 	Application(char *);
 	virtual ~Application();
@@ -72,6 +117,24 @@ public:
 	void deleteTest();
 	void readTest();
 	void updateTest();
+	void logQuorumLatency();
+	void runPhase(vector<int> &nodes, EmulNet *net, function<void(int)> step);
+	bool owns(int i);
+	bool isDriver();
+	void testRun();
+	MP2Node *ringOf(int number);
+	void failNode(int i);
+	void issueCreate(int number, string key, string value);
+	void issueRead(int number, string key);
+	void issueUpdate(int number, string key, string value);
+	void issueDelete(int number, string key);
+	void applyCommands();
+	bool eventDriven();
+	void schedule(int time, int node, int type);
+	void popEvents();
+	int nextEventTime();
+	void trackMembership();
+	void logMembershipStats();
 };
 
 #endif /* _APPLICATION_H__ */
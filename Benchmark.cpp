@@ -0,0 +1,1691 @@
+/**********************************
+ * FILE NAME: Benchmark.cpp
+ *
+ * DESCRIPTION: Micro benchmarks for the emulated network and the
+ * 				protocol data structures. Run as
+ * 				$ ./Benchmark <name>
+ * 				or without arguments to run all of them.
+ **********************************/
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "EmulNet.h"
+#include "UdpNet.h"
+#include "Log.h"
+#include "MP1Node.h"
+#include "MP2Node.h"
+
+/*
+ * Macros
+ */
+#define BENCH_TICKS 50
+#define BENCH_MSGS_PER_NODE 10
+#define BENCH_MSG_SIZE 64
+#define BENCH_TRANSPORT_NODES 10
+#define BENCH_TRANSPORT_TICKS 1000
+#define BENCH_UDP_PORT_BASE 21000
+#define BENCH_MERGE_ROUNDS 20
+#define BENCH_DETECTOR_TICKS 300
+// message drops start once the group has formed
+#define BENCH_DETECTOR_DROP_TIME 50
+#define BENCH_DETECTOR_LOAD_TIME 100
+#define BENCH_DETECTOR_FAIL_TIME 150
+#define BENCH_WIRE_ROUNDS 200
+// bytes of one entry in the raw layout the frames replaced: int id, short port, long heartbeat, long timestamp
+#define BENCH_RAW_ENTRY_SIZE 24
+#define BENCH_EXPIRY_TICKS 400
+// members go silent for longer than TREMOVE, one cycle of BENCH_SILENT_EVERY silences each
+#define BENCH_SILENT_TICKS 40
+#define BENCH_SILENT_EVERY 10
+// the sparser of the two rates the members are heard of at, in ticks
+#define BENCH_REFRESH_INTERVAL 8
+#define BENCH_RING_ROUNDS 200
+#define BENCH_SOAK_NODES 10
+#define BENCH_SOAK_TICKS 100000
+#define BENCH_SOAK_REPORT 10000
+// the nodes of a view run start over the first BENCH_VIEW_JOIN ticks
+#define BENCH_VIEW_JOIN 100
+#define BENCH_VIEW_LOAD_TIME 150
+#define BENCH_VIEW_FAIL_TIME 200
+#define BENCH_VIEW_TICKS 300
+#define BENCH_TABLE_KEYS 1000000
+#define BENCH_INDEX_ROUNDS 10
+#define BENCH_CODEC_ROUNDS 200000
+#define BENCH_LOOKUP_KEYS 100000
+
+// operator new calls of the whole program, see the replacement below
+static long allocations = 0;
+// set by a benchmark whose checks failed, main then returns FAILURE
+static bool checksFailed = false;
+
+/**
+ * FUNCTION NAME: operator new
+ *
+ * DESCRIPTION: Counts the allocations, so that a benchmark can tell how many a code path makes
+ */
+void *operator new(size_t size) {
+	allocations++;
+	void *p = malloc(size ? size : 1);
+	if ( !p ) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+/**
+ * FUNCTION NAME: nowNs
+ *
+ * DESCRIPTION: Monotonic clock in nanoseconds
+ */
+static long long nowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * FUNCTION NAME: initBenchParams
+ *
+ * DESCRIPTION: Parameters of a loss free run with numNodes peers
+ */
+static void initBenchParams(Params *par, int numNodes) {
+	par->MAX_NNB = numNodes;
+	par->EN_GPSZ = numNodes;
+	par->SINGLE_FAILURE = 0;
+	par->DROP_MSG = 0;
+	par->MSG_DROP_PROB = 0;
+	par->STEP_RATE = .25;
+	par->MAX_MSG_SIZE = 4000;
+	par->globaltime = 0;
+	par->dropmsg = 0;
+	par->allNodesJoined = 0;
+	par->CRUDTEST = CREATE_TEST;
+}
+
+/**
+ * FUNCTION NAME: countAndDrop
+ *
+ * DESCRIPTION: ENrecv callback that only counts the delivered messages
+ */
+static int countAndDrop(void *env, char *buff, int size) {
+	(*(long *)env)++;
+	EmulNet::ENrelease(buff);
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: benchEmulNetRecv
+ *
+ * DESCRIPTION: Per tick cost of the receive phase, i.e. one ENrecv per node,
+ * 				when every node sends BENCH_MSGS_PER_NODE messages to random peers per tick
+ */
+static void benchEmulNetRecv() {
+	int sizes[] = {10, 100, 1000};
+	char payload[BENCH_MSG_SIZE];
+
+	memset(payload, 0, sizeof(payload));
+	printf("emulnet_recv: %d msgs/node/tick, %d ticks\n", BENCH_MSGS_PER_NODE, BENCH_TICKS);
+
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		int numNodes = sizes[s];
+		Params *par = new Params();
+		initBenchParams(par, numNodes);
+		EmulNet *en = new EmulNet(par);
+		vector<Address> addrs(numNodes);
+		long delivered = 0;
+		long long recvNs = 0;
+
+		for ( int i = 0; i < numNodes; i++ ) {
+			en->ENinit(&addrs[i], par->PORTNUM);
+		}
+
+		srand(1);
+		for ( par->globaltime = 0; par->globaltime < BENCH_TICKS; par->globaltime++ ) {
+			for ( int i = 0; i < numNodes; i++ ) {
+				for ( int m = 0; m < BENCH_MSGS_PER_NODE; m++ ) {
+					en->ENsend(&addrs[i], &addrs[rand() % numNodes], payload, sizeof(payload));
+				}
+			}
+
+			long long start = nowNs();
+			for ( int i = 0; i < numNodes; i++ ) {
+				en->ENrecv(&addrs[i], countAndDrop, NULL, 1, &delivered);
+			}
+			recvNs += nowNs() - start;
+		}
+
+		printf("  nodes %5d  recv phase %12.1f us/tick  %8.1f ns/node  delivered %ld\n",
+				numNodes, recvNs / 1000.0 / BENCH_TICKS, (double)recvNs / BENCH_TICKS / numNodes, delivered);
+
+		delete en;
+		delete par;
+	}
+}
+
+/**
+ * FUNCTION NAME: runTransport
+ *
+ * DESCRIPTION: Sends and receives BENCH_TRANSPORT_TICKS ticks of traffic over en.
+ * 				Prints the messages per second of the send and receive phases together.
+ */
+static void runTransport(const char *name, Params *par, EmulNet *en) {
+	int numNodes = par->EN_GPSZ;
+	vector<Address> addrs(numNodes);
+	char payload[BENCH_MSG_SIZE];
+	long sent = 0;
+	long delivered = 0;
+	long long start;
+	long long ns;
+
+	memset(payload, 0, sizeof(payload));
+	for ( int i = 0; i < numNodes; i++ ) {
+		en->ENinit(&addrs[i], par->PORTNUM);
+	}
+
+	srand(1);
+	start = nowNs();
+	for ( par->globaltime = 0; par->globaltime < BENCH_TRANSPORT_TICKS; par->globaltime++ ) {
+		for ( int i = 0; i < numNodes; i++ ) {
+			for ( int m = 0; m < BENCH_MSGS_PER_NODE; m++ ) {
+				en->ENsend(&addrs[i], &addrs[rand() % numNodes], payload, sizeof(payload));
+				sent++;
+			}
+		}
+		for ( int i = 0; i < numNodes; i++ ) {
+			en->ENrecv(&addrs[i], countAndDrop, NULL, 1, &delivered);
+		}
+	}
+	ns = nowNs() - start;
+
+	printf("  %-8s sent %8ld  delivered %8ld  %10.0f msgs/s  %8.1f ns/msg\n",
+			name, sent, delivered, delivered * 1e9 / ns, (double)ns / delivered);
+}
+
+/**
+ * FUNCTION NAME: benchTransport
+ *
+ * DESCRIPTION: Throughput of the in-memory EmulNet against the loopback UDP backend
+ */
+static void benchTransport() {
+	Params *par = new Params();
+	EmulNet *en;
+
+	printf("transport: %d nodes, %d msgs/node/tick, %d ticks\n", BENCH_TRANSPORT_NODES, BENCH_MSGS_PER_NODE, BENCH_TRANSPORT_TICKS);
+
+	initBenchParams(par, BENCH_TRANSPORT_NODES);
+	en = new EmulNet(par);
+	runTransport("emulnet", par, en);
+	delete en;
+
+	initBenchParams(par, BENCH_TRANSPORT_NODES);
+	en = new UdpNet(par, BENCH_UDP_PORT_BASE);
+	runTransport("udp", par, en);
+	delete en;
+
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: encodeGossip
+ *
+ * DESCRIPTION: A PING from member 2 carrying the given entries, left in one frame however
+ * 				large it gets
+ */
+static vector<char> encodeGossip(vector<WireEntry> &entries) {
+	vector< vector<char> > frames;
+	Address sender;
+
+	sender.init();
+	sender.addr[0] = 2;
+	Codec::encodeMembers(PING, &sender, entries, INT_MAX, frames);
+	return frames[0];
+}
+
+/**
+ * FUNCTION NAME: buildGossip
+ *
+ * DESCRIPTION: A PING from member 2 carrying numMembers entries with the given heartbeat, as a
+ * 				full list gossip would
+ */
+static vector<char> buildGossip(int numMembers, long heartbeat) {
+	vector<WireEntry> entries(numMembers);
+
+	for ( int i = 0; i < numMembers; i++ ) {
+		entries[i].id = i + 2;
+		entries[i].port = 0;
+		entries[i].heartbeat = heartbeat;
+	}
+	return encodeGossip(entries);
+}
+
+/**
+ * FUNCTION NAME: benchMembershipMerge
+ *
+ * DESCRIPTION: Cost of merging one gossip message into a membership table that already
+ * 				knows every member in it, i.e. the steady state of a converged group
+ */
+static void benchMembershipMerge() {
+	int sizes[] = {100, 1000, 10000};
+	vector<LogRecord> discarded;
+
+	printf("membership_merge: full list gossip, %d messages\n", BENCH_MERGE_ROUNDS);
+
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		int numMembers = sizes[s];
+		Params *par = new Params();
+		initBenchParams(par, numMembers + 1);
+		EmulNet *en = new EmulNet(par);
+		Log *log = new Log(par);
+		Member *member = new Member();
+		Address addr;
+		long long ns = 0;
+
+		en->ENinit(&addr, par->PORTNUM);
+		MP1Node *node = new MP1Node(member, par, en, log, &addr);
+		node->initThisNode(&addr);
+
+		// the adds of the first message are logged, keep them out of dbg.log
+		Log::beginCapture(&discarded);
+		vector<char> msg = buildGossip(numMembers, 0);
+		node->recvCallBack(member, &msg[0], msg.size());
+		Log::endCapture();
+
+		for ( int r = 1; r <= BENCH_MERGE_ROUNDS; r++ ) {
+			msg = buildGossip(numMembers, r);
+			long long start = nowNs();
+			node->recvCallBack(member, &msg[0], msg.size());
+			ns += nowNs() - start;
+		}
+
+		printf("  members %6d  %12.1f us/message  %8.1f ns/entry\n",
+				numMembers, ns / 1000.0 / BENCH_MERGE_ROUNDS, (double)ns / BENCH_MERGE_ROUNDS / numMembers);
+
+		delete node;
+		delete member;
+		delete log;
+		delete en;
+		delete par;
+		discarded.clear();
+	}
+}
+
+/**
+ * FUNCTION NAME: silentAt
+ *
+ * DESCRIPTION: Whether bench member i sends no heartbeat on tick time. Each member is silent for
+ * 				BENCH_SILENT_TICKS ticks, longer than TREMOVE, out of every BENCH_SILENT_EVERY *
+ * 				BENCH_SILENT_TICKS; a prime stride spreads the members' silences over that cycle.
+ */
+static bool silentAt(int i, int time) {
+	int cycle = BENCH_SILENT_EVERY * BENCH_SILENT_TICKS;
+	return (time + (int)((long)i * 7919 % cycle)) % cycle < BENCH_SILENT_TICKS;
+}
+
+/**
+ * FUNCTION NAME: benchFailureDetection
+ *
+ * DESCRIPTION: Per tick cost of the members' removal deadlines, with a share of the members
+ * 				silent at any time, so that members expire and come back throughout. The others
+ * 				are heard of every tick, as with ALL gossip, or every BENCH_REFRESH_INTERVAL
+ * 				ticks, as with sparse FANOUT gossip. The node
+ * 				figures time the gossip merge, which moves the deadlines of the members heard of,
+ * 				and the node loop, which removes the expired ones. The wheel and scan figures
+ * 				run the same refreshes and expiries on the bare structures: a TimerWheel, and a
+ * 				timestamp per member that is looked at every tick, as the list scan it replaced did.
+ */
+static void benchFailureDetection() {
+	int sizes[] = {100, 1000, 10000};
+	int intervals[] = {1, BENCH_REFRESH_INTERVAL};
+	vector<LogRecord> discarded;
+
+	printf("failure_detection: %d ticks, each member silent %d ticks out of %d\n",
+			BENCH_EXPIRY_TICKS, BENCH_SILENT_TICKS, BENCH_SILENT_EVERY * BENCH_SILENT_TICKS);
+
+	for ( unsigned int r = 0; r < sizeof(intervals)/sizeof(intervals[0]); r++ ) {
+		printf("  heard of every %d ticks\n", intervals[r]);
+		for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+			int numMembers = sizes[s];
+			Params *par = new Params();
+			initBenchParams(par, numMembers + 1);
+			// no gossip rounds, the node loop only beats and looks for failures
+			par->GOSSIP = FANOUT_GOSSIP;
+			par->GOSSIP_PERIOD = INT_MAX;
+			EmulNet *en = new EmulNet(par);
+			Log *log = new Log(par);
+			Member *member = new Member();
+			Address addr;
+			long long refreshNs = 0;
+			long long expireNs = 0;
+			long removed = 0;
+			vector<WireEntry> entries;
+			vector< vector<int> > heard(BENCH_EXPIRY_TICKS + 1);
+
+			en->ENinit(&addr, par->PORTNUM);
+			MP1Node *node = new MP1Node(member, par, en, log, &addr);
+			node->initThisNode(&addr);
+			member->inGroup = true;
+
+			// the adds and removals are logged, keep them out of dbg.log
+			Log::beginCapture(&discarded);
+			vector<char> msg = buildGossip(numMembers, 0);
+			node->recvCallBack(member, &msg[0], msg.size());
+
+			for ( par->globaltime = 1; par->globaltime <= BENCH_EXPIRY_TICKS; par->globaltime++ ) {
+				entries.clear();
+				for ( int i = 0; i < numMembers; i++ ) {
+					if ( !silentAt(i, par->globaltime) && (par->globaltime + i) % intervals[r] == 0 ) {
+						heard[par->globaltime].push_back(i);
+						WireEntry entry;
+						entry.id = i + 2;
+						entry.port = 0;
+						entry.heartbeat = par->globaltime;
+						entries.push_back(entry);
+					}
+				}
+				msg = encodeGossip(entries);
+
+				long long start = nowNs();
+				node->recvCallBack(member, &msg[0], msg.size());
+				refreshNs += nowNs() - start;
+
+				int before = member->memberList.size();
+				start = nowNs();
+				node->nodeLoop();
+				expireNs += nowNs() - start;
+				removed += before - (int)member->memberList.size();
+				discarded.clear();
+			}
+			Log::endCapture();
+
+			// the same refreshes and expiries on the bare structures
+			TimerWheel wheel;
+			vector<int> stamps(numMembers, 0);
+			vector<long> expired;
+			long long wheelNs = 0;
+			long long scanNs = 0;
+			long wheelExpired = 0;
+			long scanExpired = 0;
+
+			for ( int i = 0; i < numMembers; i++ ) {
+				wheel.schedule(i, TREMOVE + 1);
+			}
+			for ( int t = 1; t <= BENCH_EXPIRY_TICKS; t++ ) {
+				vector<int> &ids = heard[t];
+
+				long long start = nowNs();
+				for ( unsigned int k = 0; k < ids.size(); k++ ) {
+					wheel.schedule(ids[k], t + TREMOVE + 1);
+				}
+				expired.clear();
+				wheel.advance(t, expired);
+				wheelNs += nowNs() - start;
+				wheelExpired += expired.size();
+
+				start = nowNs();
+				for ( unsigned int k = 0; k < ids.size(); k++ ) {
+					stamps[ids[k]] = t;
+				}
+				// -1 marks a member already expired
+				for ( int i = 0; i < numMembers; i++ ) {
+					if ( stamps[i] >= 0 && t - stamps[i] > TREMOVE ) {
+						stamps[i] = -1;
+						scanExpired++;
+					}
+				}
+				scanNs += nowNs() - start;
+			}
+
+			printf("    members %6d  node: refresh %9.1f ns/tick  expire %9.1f ns/tick  removed %ld\n",
+					numMembers, (double)refreshNs / BENCH_EXPIRY_TICKS, (double)expireNs / BENCH_EXPIRY_TICKS, removed);
+			printf("                   wheel %9.1f ns/tick  scan %9.1f ns/tick  expired %ld / %ld\n",
+					(double)wheelNs / BENCH_EXPIRY_TICKS, (double)scanNs / BENCH_EXPIRY_TICKS, wheelExpired, scanExpired);
+
+			delete node;
+			delete member;
+			delete log;
+			delete en;
+			delete par;
+			discarded.clear();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: benchTimerWheel
+ *
+ * DESCRIPTION: Arms deadlines from ticks on either side of the level 1 and the overflow
+ * 				boundaries, every delay up to past the end of level 1, then advances the wheel
+ * 				one tick at a time. Checks that each deadline fires on exactly its own tick, and
+ * 				fails the run otherwise.
+ */
+static void benchTimerWheel() {
+	int horizon = TIMER_SLOTS * TIMER_SLOTS + 2 * TIMER_SLOTS;
+	int starts[] = {0, 1, TIMER_SLOTS - 1, TIMER_SLOTS, TIMER_SLOTS + 1, 2 * TIMER_SLOTS - 1,
+			TIMER_SLOTS * TIMER_SLOTS - 1, TIMER_SLOTS * TIMER_SLOTS, TIMER_SLOTS * TIMER_SLOTS + 1};
+	int numStarts = sizeof(starts)/sizeof(starts[0]);
+	TimerWheel wheel;
+	unordered_map<long, int> due;
+	vector<long> expired;
+	long armed = 0;
+	long early = 0;
+	long late = 0;
+	long long advanceNs = 0;
+	int time = 0;
+
+	// advances to tick until, checking every deadline that fires on the way
+	auto advanceTo = [&](int until) {
+		while ( time < until ) {
+			time++;
+			expired.clear();
+			long long start = nowNs();
+			wheel.advance(time, expired);
+			advanceNs += nowNs() - start;
+			for ( unsigned int k = 0; k < expired.size(); k++ ) {
+				int expected = due[expired[k]];
+				early += expected > time;
+				late += expected < time;
+				due.erase(expired[k]);
+			}
+		}
+	};
+
+	for ( int s = 0; s < numStarts; s++ ) {
+		advanceTo(starts[s]);
+		for ( int d = 1; d <= horizon; d++ ) {
+			long key = (long)s * (horizon + 1) + d;
+			wheel.schedule(key, starts[s] + d);
+			due[key] = starts[s] + d;
+			armed++;
+		}
+	}
+	advanceTo(starts[numStarts - 1] + horizon + 1);
+
+	printf("timer_wheel: %ld deadlines from %d start ticks, %.1f ns/tick advancing\n",
+			armed, numStarts, (double)advanceNs / time);
+	printf("  fired early %ld, late %ld, never %d: %s\n", early, late, (int)due.size(),
+			early == 0 && late == 0 && due.empty() ? "ok" : "FAILED");
+	if ( early != 0 || late != 0 || !due.empty() ) {
+		checksFailed = true;
+	}
+}
+
+/**
+ * FUNCTION NAME: benchRingUpdate
+ *
+ * DESCRIPTION: Cost of MP2's ring update when membership did not change and when one member
+ * 				joined, against rebuilding and sorting the ring from the membership list, as
+ * 				every update did before MP1 published its changes
+ */
+static void benchRingUpdate() {
+	int sizes[] = {100, 1000, 10000};
+	vector<LogRecord> discarded;
+
+	printf("ring_update: %d updates\n", BENCH_RING_ROUNDS);
+
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		int numMembers = sizes[s];
+		Params *par = new Params();
+		initBenchParams(par, numMembers + 2);
+		EmulNet *en = new EmulNet(par);
+		Log *log = new Log(par);
+		Member *member = new Member();
+		Address addr;
+		long long steadyNs = 0;
+		long long joinNs = 0;
+		long long rebuildNs = 0;
+
+		en->ENinit(&addr, par->PORTNUM);
+		MP1Node *node = new MP1Node(member, par, en, log, &addr);
+		// the ring owns member from here on
+		MP2Node *ring = new MP2Node(member, par, en, log, &addr);
+		node->initThisNode(&addr);
+		member->inGroup = true;
+
+		Log::beginCapture(&discarded);
+		vector<char> msg = buildGossip(numMembers, 0);
+		node->recvCallBack(member, &msg[0], msg.size());
+		ring->updateRing();
+
+		for ( int r = 0; r < BENCH_RING_ROUNDS; r++ ) {
+			long long start = nowNs();
+			ring->updateRing();
+			steadyNs += nowNs() - start;
+
+			// one more member joins
+			msg = buildGossip(numMembers + 1 + r, 0);
+			node->recvCallBack(member, &msg[0], msg.size());
+			start = nowNs();
+			ring->updateRing();
+			joinNs += nowNs() - start;
+
+			start = nowNs();
+			vector<Node> rebuilt;
+			for ( unsigned int i = 0; i < member->memberList.size(); i++ ) {
+				Address memberAddress;
+				memcpy(&memberAddress.addr[0], &member->memberList[i].id, sizeof(int));
+				memcpy(&memberAddress.addr[4], &member->memberList[i].port, sizeof(short));
+				rebuilt.emplace_back(Node(memberAddress));
+			}
+			sort(rebuilt.begin(), rebuilt.end());
+			rebuildNs += nowNs() - start;
+		}
+		Log::endCapture();
+
+		printf("  members %6d  unchanged %9.1f ns/update  one join %9.1f ns/update  rebuild %11.1f ns/update\n",
+				numMembers, (double)steadyNs / BENCH_RING_ROUNDS, (double)joinNs / BENCH_RING_ROUNDS,
+				(double)rebuildNs / BENCH_RING_ROUNDS);
+
+		delete ring;
+		delete node;
+		delete log;
+		delete en;
+		delete par;
+		discarded.clear();
+	}
+}
+
+/**
+ * FUNCTION NAME: benchWireFormat
+ *
+ * DESCRIPTION: Size of a full list gossip in compact frames against the raw layout, and the
+ * 				cost of encoding and decoding it. The heartbeats spread over 50 values around
+ * 				1000, as in a group whose members joined over a few dozen ticks. Then checks
+ * 				that a SWIM and a HYPARVIEW frame decode to what was encoded, and that they
+ * 				do not once cut short.
+ */
+static void benchWireFormat() {
+	int sizes[] = {100, 1000, 10000};
+	Params *par = new Params();
+	initBenchParams(par, 1);
+	int maxBytes = par->MAX_MSG_SIZE - (int)sizeof(en_msg) - 1;
+
+	printf("wire_format: full list gossip, frames of at most %d bytes, %d rounds\n", maxBytes, BENCH_WIRE_ROUNDS);
+
+	srand(1);
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		int numMembers = sizes[s];
+		vector<WireEntry> entries(numMembers);
+		vector<WireEntry> decoded;
+		vector< vector<char> > frames;
+		Address sender;
+		int type;
+		long bytes = 0;
+		long long encodeNs = 0;
+		long long decodeNs = 0;
+		int count = 0;
+
+		for ( int i = 0; i < numMembers; i++ ) {
+			entries[i].id = i + 1;
+			entries[i].port = 0;
+			entries[i].heartbeat = 1000 + rand() % 50;
+		}
+		random_shuffle(entries.begin(), entries.end());
+		sender.init();
+		sender.addr[0] = 1;
+
+		for ( int r = 0; r < BENCH_WIRE_ROUNDS; r++ ) {
+			long long start = nowNs();
+			count = Codec::encodeMembers(PING, &sender, entries, maxBytes, frames);
+			encodeNs += nowNs() - start;
+
+			start = nowNs();
+			for ( int f = 0; f < count; f++ ) {
+				if ( !Codec::decodeMembers(&frames[f][0], frames[f].size(), type, &sender, decoded) ) {
+					printf("  members %6d  frame %d does not decode\n", numMembers, f);
+					return;
+				}
+			}
+			decodeNs += nowNs() - start;
+		}
+		for ( int f = 0; f < count; f++ ) {
+			bytes += frames[f].size();
+		}
+
+		printf("  members %6d  %8ld bytes in %3d frames  %5.2f bytes/entry (raw %d, %3.0f%%)  encode %6.1f ns/entry  decode %6.1f ns/entry\n",
+				numMembers, bytes, count, (double)bytes / numMembers, BENCH_RAW_ENTRY_SIZE,
+				100.0 * bytes / numMembers / BENCH_RAW_ENTRY_SIZE,
+				(double)encodeNs / BENCH_WIRE_ROUNDS / numMembers, (double)decodeNs / BENCH_WIRE_ROUNDS / numMembers);
+	}
+
+	// a SWIM ping carrying a full piggyback, and a shuffle carrying a sample
+	SwimMessage swim, swimBack;
+	ViewMessage view, viewBack;
+	vector<SwimUpdate> updates(SWIM_PIGGYBACK), updatesBack;
+	vector<long> keys(VIEW_SHUFFLE_ACTIVE + VIEW_SHUFFLE_PASSIVE), keysBack;
+	vector<char> frame;
+	memset(&swim, 0, sizeof(swim));
+	swim.type = SWIM_PING;
+	swim.seq = 12345;
+	swim.origin[0] = 7;
+	swim.target[0] = 42;
+	for ( unsigned int k = 0; k < updates.size(); k++ ) {
+		updates[k].id = 1 + rand() % 1000;
+		updates[k].port = 0;
+		updates[k].state = rand() % 3;
+		updates[k].incarnation = rand() % 100;
+	}
+	view.type = VIEW_SHUFFLE;
+	view.ttl = 6;
+	view.flag = 0;
+	view.sender = 7L << 16;
+	view.origin = 9L << 16;
+	for ( unsigned int k = 0; k < keys.size(); k++ ) {
+		keys[k] = (long)(1 + rand() % 1000) << 16;
+	}
+
+	Codec::encodeSwim(swim, updates, frame);
+	bool swimOk = Codec::decodeSwim(&frame[0], frame.size(), swimBack, updatesBack) && swimBack.type == swim.type &&
+			swimBack.seq == swim.seq && memcmp(swimBack.origin, swim.origin, 6) == 0 && memcmp(swimBack.target, swim.target, 6) == 0 &&
+			memcmp(swimBack.relay, swim.relay, 6) == 0 && updatesBack.size() == updates.size() &&
+			!Codec::decodeSwim(&frame[0], frame.size() - 1, swimBack, updatesBack);
+	for ( unsigned int k = 0; swimOk && k < updates.size(); k++ ) {
+		swimOk = updatesBack[k].id == updates[k].id && updatesBack[k].port == updates[k].port &&
+				updatesBack[k].state == updates[k].state && updatesBack[k].incarnation == updates[k].incarnation;
+	}
+	printf("  swim ping, %d updates: %3d bytes  %s\n", SWIM_PIGGYBACK, (int)frame.size(), swimOk ? "ok" : "FAILED");
+
+	Codec::encodeView(view, keys.data(), keys.size(), frame);
+	bool viewOk = Codec::decodeView(&frame[0], frame.size(), viewBack, keysBack) && viewBack.type == view.type &&
+			viewBack.ttl == view.ttl && viewBack.flag == view.flag && viewBack.sender == view.sender &&
+			viewBack.origin == view.origin && keysBack == keys && !Codec::decodeView(&frame[0], frame.size() - 1, viewBack, keysBack);
+	printf("  view shuffle, %d keys: %3d bytes  %s\n", (int)keys.size(), (int)frame.size(), viewOk ? "ok" : "FAILED");
+	if ( !swimOk || !viewOk ) {
+		checksFailed = true;
+	}
+
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: residentBytes
+ *
+ * DESCRIPTION: Resident set size of this process
+ */
+static long residentBytes() {
+	long pages = 0, resident = 0;
+	FILE *statm = fopen("/proc/self/statm", "r");
+
+	if ( statm ) {
+		if ( fscanf(statm, "%ld %ld", &pages, &resident) != 2 ) {
+			resident = 0;
+		}
+		fclose(statm);
+	}
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * CLASS NAME: LoopbackNet
+ *
+ * DESCRIPTION: Delivers every message at the next receive, without the per tick traffic
+ * 				counters behind msgcount.log. Those grow with the length of a run by design,
+ * 				which would hide whether the nodes themselves leak.
+ */
+class LoopbackNet : public EmulNet {
+private:
+	vector< vector<en_msg *> > boxes;
+public:
+	LoopbackNet(Params *p): EmulNet(p) {}
+
+	virtual ~LoopbackNet() {
+		for ( unsigned int id = 0; id < boxes.size(); id++ ) {
+			for ( unsigned int k = 0; k < boxes[id].size(); k++ ) {
+				free(boxes[id][k]);
+			}
+		}
+	}
+
+	virtual int ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+		int dst = addressId(toaddr);
+		en_msg *em = (en_msg *)malloc(sizeof(en_msg) + size);
+
+		em->size = size;
+		em->from = *myaddr;
+		em->to = *toaddr;
+		memcpy((char *)(em + 1), data, size);
+		if ( dst >= (int)boxes.size() ) {
+			boxes.resize(dst + 1);
+		}
+		boxes[dst].push_back(em);
+		return size;
+	}
+
+	virtual int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+		int dst = addressId(myaddr);
+
+		if ( dst < 0 || dst >= (int)boxes.size() ) {
+			return 0;
+		}
+		for ( unsigned int k = 0; k < boxes[dst].size(); k++ ) {
+			(*enq)(queue, (char *)(boxes[dst][k] + 1), boxes[dst][k]->size);
+		}
+		boxes[dst].clear();
+		return 0;
+	}
+};
+
+/**
+ * FUNCTION NAME: benchMp1Soak
+ *
+ * DESCRIPTION: Runs the MP1 protocol alone, loss and failure free, for BENCH_SOAK_TICKS ticks
+ * 				over a LoopbackNet. Prints the resident memory every BENCH_SOAK_REPORT ticks,
+ * 				which stays flat when nothing leaks, and the operator new calls the nodes'
+ * 				loops made per tick. Messages are allocated by the network with malloc and
+ * 				are not counted.
+ */
+static void benchMp1Soak() {
+	Params *par = new Params();
+	initBenchParams(par, BENCH_SOAK_NODES);
+	par->SEED = 1;
+	EmulNet *en = new LoopbackNet(par);
+	Log *log = new Log(par);
+	vector<LogRecord> discarded;
+	vector<Member *> members(BENCH_SOAK_NODES);
+	vector<MP1Node *> nodes(BENCH_SOAK_NODES);
+	long loopAllocations = 0;
+
+	printf("mp1_soak: %d nodes, %d ticks\n", BENCH_SOAK_NODES, BENCH_SOAK_TICKS);
+
+	for ( int i = 0; i < BENCH_SOAK_NODES; i++ ) {
+		Address addr;
+		en->ENinit(&addr, par->PORTNUM);
+		members[i] = new Member();
+		nodes[i] = new MP1Node(members[i], par, en, log, &addr);
+	}
+
+	srand(1);
+	Log::beginCapture(&discarded);
+	for ( par->globaltime = 0; par->globaltime < BENCH_SOAK_TICKS; par->globaltime++ ) {
+		int now = par->globaltime;
+
+		for ( int i = 0; i < BENCH_SOAK_NODES; i++ ) {
+			if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->recvLoop();
+			}
+		}
+		long before = allocations;
+		for ( int i = 0; i < BENCH_SOAK_NODES; i++ ) {
+			if ( now == (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeStart(NULL, par->PORTNUM);
+			}
+			else if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeLoop();
+			}
+		}
+		loopAllocations += allocations - before;
+		discarded.clear();
+
+		if ( (now + 1) % BENCH_SOAK_REPORT == 0 ) {
+			printf("  tick %6d  resident %8ld KB  %8.3f allocations/tick\n",
+					now + 1, residentBytes() / 1024, (double)loopAllocations / BENCH_SOAK_REPORT);
+			loopAllocations = 0;
+		}
+	}
+	Log::endCapture();
+
+	for ( int i = 0; i < BENCH_SOAK_NODES; i++ ) {
+		delete nodes[i];
+		delete members[i];
+	}
+	delete log;
+	delete en;
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: runDetector
+ *
+ * DESCRIPTION: Runs the MP1 protocol alone on numNodes nodes with the given detector, gossip and
+ * 				GOSSIP_DIGEST epoch, loses dropProb of the messages once
+ * 				the group has formed, and fails a tenth of the nodes at BENCH_DETECTOR_FAIL_TIME.
+ * 				Prints the messages and bytes each node sends per tick before the failures, the
+ * 				ticks until no alive node lists a failed one, and how often an alive one was removed.
+ */
+static void runDetector(const char *name, int detector, int gossip, int digest, int numNodes, double dropProb) {
+	Params *par = new Params();
+	initBenchParams(par, numNodes);
+	par->DETECTOR = detector;
+	par->GOSSIP = gossip;
+	par->GOSSIP_DIGEST = digest;
+	par->SEED = 1;
+	par->DROP_MSG = dropProb > 0;
+	par->MSG_DROP_PROB = dropProb;
+	EmulNet *en = new EmulNet(par);
+	Log *log = new Log(par);
+	vector<LogRecord> discarded;
+	vector<Member *> members(numNodes);
+	vector<MP1Node *> nodes(numNodes);
+	vector<int> failedAt(numNodes, -1);
+	vector<int> detectedAt(numNodes, -1);
+	long loadMessages = 0;
+	long loadBytes = 0;
+	int falseRemovals = 0;
+	int numFailures = max(1, numNodes / 10);
+
+	for ( int i = 0; i < numNodes; i++ ) {
+		Address addr;
+		en->ENinit(&addr, par->PORTNUM);
+		members[i] = new Member();
+		nodes[i] = new MP1Node(members[i], par, en, log, &addr);
+	}
+
+	srand(1);
+	Log::beginCapture(&discarded);
+	for ( par->globaltime = 0; par->globaltime < BENCH_DETECTOR_TICKS; par->globaltime++ ) {
+		int now = par->globaltime;
+		par->dropmsg = par->DROP_MSG && now >= BENCH_DETECTOR_DROP_TIME;
+
+		if ( now == BENCH_DETECTOR_LOAD_TIME || now == BENCH_DETECTOR_FAIL_TIME ) {
+			long messages = 0, bytes = 0;
+			for ( int i = 0; i < numNodes; i++ ) {
+				messages += nodes[i]->getSentMessages();
+				bytes += nodes[i]->getSentBytes();
+			}
+			loadMessages = messages - loadMessages;
+			loadBytes = bytes - loadBytes;
+		}
+		if ( now == BENCH_DETECTOR_FAIL_TIME ) {
+			// the last nodes, never the introducer
+			for ( int k = 0; k < numFailures; k++ ) {
+				members[numNodes - 1 - k]->bFailed = true;
+				failedAt[numNodes - 1 - k] = now;
+			}
+		}
+
+		for ( int i = 0; i < numNodes; i++ ) {
+			if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->recvLoop();
+			}
+		}
+		for ( int i = 0; i < numNodes; i++ ) {
+			if ( now == (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeStart(NULL, par->PORTNUM);
+			}
+			else if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeLoop();
+			}
+		}
+
+		for ( int i = 0; i < numNodes; i++ ) {
+			vector<int> &removed = nodes[i]->getRemovedIds();
+			for ( unsigned int k = 0; k < removed.size() && !members[i]->bFailed; k++ ) {
+				if ( failedAt[removed[k] - 1] < 0 ) {
+					falseRemovals++;
+				}
+			}
+			removed.clear();
+		}
+		for ( int j = 0; j < numNodes; j++ ) {
+			if ( failedAt[j] < 0 || detectedAt[j] >= 0 ) {
+				continue;
+			}
+			bool listed = false;
+			for ( int i = 0; i < numNodes && !listed; i++ ) {
+				listed = !members[i]->bFailed && nodes[i]->knows(*(int *)&members[j]->addr.addr[0], *(short *)&members[j]->addr.addr[4]);
+			}
+			if ( !listed ) {
+				detectedAt[j] = now;
+			}
+		}
+		discarded.clear();
+	}
+	Log::endCapture();
+
+	int detected = 0, detectSum = 0, detectMax = 0;
+	for ( int j = 0; j < numNodes; j++ ) {
+		if ( detectedAt[j] >= 0 ) {
+			detected++;
+			detectSum += detectedAt[j] - failedAt[j];
+			detectMax = max(detectMax, detectedAt[j] - failedAt[j]);
+		}
+	}
+	int loadTicks = BENCH_DETECTOR_FAIL_TIME - BENCH_DETECTOR_LOAD_TIME;
+	printf("  %-10s nodes %4d  drop %3.0f%%  %6.2f msgs/node/tick  %8.1f B/node/tick  detected %d/%d avg %5.1f max %3d  false removals %d\n",
+			name, numNodes, dropProb * 100, (double)loadMessages / loadTicks / numNodes, (double)loadBytes / loadTicks / numNodes,
+			detected, numFailures, detected ? (double)detectSum / detected : 0.0, detectMax, falseRemovals);
+
+	for ( int i = 0; i < numNodes; i++ ) {
+		delete nodes[i];
+		delete members[i];
+	}
+	delete log;
+	delete en;
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: benchDetector
+ *
+ * DESCRIPTION: Heartbeat gossip against SWIM and phi accrual: per node load, detection time and false removals
+ */
+static void benchDetector() {
+	int sizes[] = {10, 50, 100};
+	double drops[] = {0, 0.1, 0.3};
+
+	printf("detector: %d ticks, %d%% of the nodes fail at tick %d\n", BENCH_DETECTOR_TICKS, 10, BENCH_DETECTOR_FAIL_TIME);
+	for ( unsigned int d = 0; d < sizeof(drops)/sizeof(drops[0]); d++ ) {
+		for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+			runDetector("heartbeat", HEARTBEAT_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("swim", SWIM_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("phi", PHI_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("hb/fanout", HEARTBEAT_DETECTOR, FANOUT_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("phi/fanout", PHI_DETECTOR, FANOUT_GOSSIP, 0, sizes[s], drops[d]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: benchDigest
+ *
+ * DESCRIPTION: Gossip of the whole list against digest-first gossip at a few epochs: per node load,
+ * 				detection time and false removals
+ */
+static void benchDigest() {
+	int sizes[] = {10, 50, 100};
+	double drops[] = {0, 0.1};
+
+	printf("digest: %d ticks, %d%% of the nodes fail at tick %d\n", BENCH_DETECTOR_TICKS, 10, BENCH_DETECTOR_FAIL_TIME);
+	for ( unsigned int d = 0; d < sizeof(drops)/sizeof(drops[0]); d++ ) {
+		for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+			runDetector("list", HEARTBEAT_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("digest/8", HEARTBEAT_DETECTOR, ALL_GOSSIP, 8, sizes[s], drops[d]);
+			runDetector("digest/4", HEARTBEAT_DETECTOR, ALL_GOSSIP, 4, sizes[s], drops[d]);
+			runDetector("fanout", HEARTBEAT_DETECTOR, FANOUT_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("fanout/8", HEARTBEAT_DETECTOR, FANOUT_GOSSIP, 8, sizes[s], drops[d]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: benchRing
+ *
+ * DESCRIPTION: Heartbeat gossip against heartbeats between ring neighbours: per node load,
+ * 				detection time and false removals
+ */
+static void benchRing() {
+	int sizes[] = {10, 50, 100};
+	double drops[] = {0, 0.1};
+
+	printf("ring: %d ticks, %d%% of the nodes fail at tick %d\n", BENCH_DETECTOR_TICKS, 10, BENCH_DETECTOR_FAIL_TIME);
+	for ( unsigned int d = 0; d < sizeof(drops)/sizeof(drops[0]); d++ ) {
+		for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+			runDetector("heartbeat", HEARTBEAT_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("hb/fanout", HEARTBEAT_DETECTOR, FANOUT_GOSSIP, 0, sizes[s], drops[d]);
+			runDetector("ring", RING_DETECTOR, ALL_GOSSIP, 0, sizes[s], drops[d]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: viewComponent
+ *
+ * DESCRIPTION: Nodes in the largest connected part of the overlay the active views of the alive
+ * 				nodes form, links taken both ways
+ */
+static int viewComponent(vector<Member *> &members, vector<MP1Node *> &nodes) {
+	int numNodes = nodes.size();
+	vector<int> parent(numNodes);
+	vector<int> size(numNodes, 0);
+	vector<long> keys;
+	int largest = 0;
+
+	for ( int i = 0; i < numNodes; i++ ) {
+		parent[i] = i;
+	}
+	for ( int i = 0; i < numNodes; i++ ) {
+		if ( members[i]->bFailed ) {
+			continue;
+		}
+		nodes[i]->getActiveView(keys);
+		for ( unsigned int k = 0; k < keys.size(); k++ ) {
+			// ids are handed out from 1 in node order
+			int j = (keys[k] >> 16) - 1;
+			if ( j < 0 || j >= numNodes || members[j]->bFailed ) {
+				continue;
+			}
+			int a = i, b = j;
+			while ( parent[a] != a ) {
+				a = parent[a] = parent[parent[a]];
+			}
+			while ( parent[b] != b ) {
+				b = parent[b] = parent[parent[b]];
+			}
+			parent[a] = b;
+		}
+	}
+	for ( int i = 0; i < numNodes; i++ ) {
+		if ( members[i]->bFailed ) {
+			continue;
+		}
+		int a = i;
+		while ( parent[a] != a ) {
+			a = parent[a];
+		}
+		largest = max(largest, ++size[a]);
+	}
+	return largest;
+}
+
+/**
+ * FUNCTION NAME: runView
+ *
+ * DESCRIPTION: Runs the MP1 protocol alone on numNodes nodes that start over BENCH_VIEW_JOIN ticks,
+ * 				with the given view, and fails a tenth of them at BENCH_VIEW_FAIL_TIME. Prints the
+ * 				resident memory per node once the group has formed, network included, the messages
+ * 				and bytes a node sends per tick, the view sizes, how many alive nodes the largest
+ * 				connected part of the overlay holds before the failures and at the end, and the ticks
+ * 				until no active view holds a failed node. Runs that keep the full set also print
+ * 				the ticks until no list holds one, -1 if one still does at the end.
+ */
+static void runView(const char *name, int view, int ring, int numNodes) {
+	Params *par = new Params();
+	initBenchParams(par, numNodes);
+	par->STEP_RATE = (double)BENCH_VIEW_JOIN / numNodes;
+	par->VIEW = view;
+	par->VIEW_RING = ring;
+	par->GOSSIP = FANOUT_GOSSIP;
+	par->SEED = 1;
+	long baseline = residentBytes();
+	EmulNet *en = new EmulNet(par);
+	Log *log = new Log(par);
+	vector<LogRecord> discarded;
+	vector<Member *> members(numNodes);
+	vector<MP1Node *> nodes(numNodes);
+	vector<long> keys;
+	long loadMessages = 0, loadBytes = 0, resident = 0;
+	int before = 0, after = 0, repaired = -1, removed = -1;
+	double active = 0, passive = 0;
+	int numFailures = numNodes / 10;
+	bool lists = view == FULL_VIEW || ring;
+
+	for ( int i = 0; i < numNodes; i++ ) {
+		Address addr;
+		en->ENinit(&addr, par->PORTNUM);
+		members[i] = new Member();
+		nodes[i] = new MP1Node(members[i], par, en, log, &addr);
+	}
+
+	srand(1);
+	Log::beginCapture(&discarded);
+	for ( par->globaltime = 0; par->globaltime < BENCH_VIEW_TICKS; par->globaltime++ ) {
+		int now = par->globaltime;
+
+		if ( now == BENCH_VIEW_LOAD_TIME || now == BENCH_VIEW_FAIL_TIME ) {
+			long messages = 0, bytes = 0;
+			for ( int i = 0; i < numNodes; i++ ) {
+				messages += nodes[i]->getSentMessages();
+				bytes += nodes[i]->getSentBytes();
+			}
+			loadMessages = messages - loadMessages;
+			loadBytes = bytes - loadBytes;
+		}
+		if ( now == BENCH_VIEW_FAIL_TIME ) {
+			resident = residentBytes() - baseline;
+			before = viewComponent(members, nodes);
+			for ( int i = 0; i < numNodes; i++ ) {
+				nodes[i]->getActiveView(keys);
+				active += keys.size();
+				passive += nodes[i]->getPassiveSize();
+			}
+			// the last nodes, never the introducer
+			for ( int k = 0; k < numFailures; k++ ) {
+				members[numNodes - 1 - k]->bFailed = true;
+			}
+		}
+
+		for ( int i = 0; i < numNodes; i++ ) {
+			if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->recvLoop();
+			}
+		}
+		for ( int i = 0; i < numNodes; i++ ) {
+			if ( now == (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeStart(NULL, par->PORTNUM);
+			}
+			else if ( now > (int)(par->STEP_RATE*i) ) {
+				nodes[i]->nodeLoop();
+			}
+		}
+		discarded.clear();
+
+		if ( now >= BENCH_VIEW_FAIL_TIME && (repaired < 0 || (lists && removed < 0)) ) {
+			bool activeHolds = false, listHolds = false;
+			for ( int i = 0; i < numNodes - numFailures && !(activeHolds && listHolds); i++ ) {
+				nodes[i]->getActiveView(keys);
+				for ( unsigned int k = 0; k < keys.size(); k++ ) {
+					activeHolds = activeHolds || (keys[k] >> 16) > numNodes - numFailures;
+				}
+				for ( int j = numNodes - numFailures; j < numNodes && lists && !listHolds; j++ ) {
+					listHolds = nodes[i]->knows(*(int *)&members[j]->addr.addr[0], *(short *)&members[j]->addr.addr[4]);
+				}
+			}
+			if ( repaired < 0 && !activeHolds ) {
+				repaired = now - BENCH_VIEW_FAIL_TIME;
+			}
+			if ( lists && removed < 0 && !listHolds ) {
+				removed = now - BENCH_VIEW_FAIL_TIME;
+			}
+		}
+	}
+	Log::endCapture();
+	after = viewComponent(members, nodes);
+
+	int loadTicks = BENCH_VIEW_FAIL_TIME - BENCH_VIEW_LOAD_TIME;
+	printf("  %-10s nodes %6d  %7.1f KB/node  %6.2f msgs/node/tick  %8.1f B/node/tick",
+			name, numNodes, (double)resident / 1024 / numNodes, (double)loadMessages / loadTicks / numNodes,
+			(double)loadBytes / loadTicks / numNodes);
+	if ( view == HYPARVIEW_VIEW ) {
+		printf("  active %3.1f passive %4.1f  connected %d/%d then %d/%d  repaired %d",
+				active / numNodes, passive / numNodes, before, numNodes, after, numNodes - numFailures, repaired);
+	}
+	if ( lists ) {
+		printf("  gone from lists %d", removed);
+	}
+	printf("\n");
+
+	for ( int i = 0; i < numNodes; i++ ) {
+		delete nodes[i];
+		delete members[i];
+	}
+	delete log;
+	delete en;
+	delete par;
+}
+
+/**
+ * FUNCTION NAME: benchView
+ *
+ * DESCRIPTION: Memory, load and overlay health of the HYPARVIEW partial views at up to 50000 nodes,
+ * 				against the full list where it still fits
+ */
+static void benchView() {
+	printf("view: %d ticks, nodes start over %d ticks, %d%% fail at tick %d\n", BENCH_VIEW_TICKS, BENCH_VIEW_JOIN, 10, BENCH_VIEW_FAIL_TIME);
+	runView("full", FULL_VIEW, 0, 1000);
+	runView("view+ring", HYPARVIEW_VIEW, 1, 1000);
+	runView("view", HYPARVIEW_VIEW, 0, 1000);
+	runView("view", HYPARVIEW_VIEW, 0, 10000);
+	runView("view", HYPARVIEW_VIEW, 0, 50000);
+}
+
+/**
+ * CLASS NAME: MapTable
+ *
+ * DESCRIPTION: The std::map the key-value store kept before HashTable held its own slots of
+ * 				entries, with the operations as they were: entries were stored as
+ * 				"value:timestamp:replica" strings and split again on every read, and update
+ * 				and delete copied the string first
+ */
+class MapTable {
+public:
+	map<string, string> hashTable;
+	Entry parsed;
+	static string format(const Entry &entry) {
+		return entry.value + ":" + to_string(entry.timestamp) + ":" + to_string(entry.replica);
+	}
+	string raw(const string &key) {
+		map<string, string>::iterator search = hashTable.find(key);
+		return search != hashTable.end() ? search->second : "";
+	}
+	bool create(const string &key, const Entry &value) {
+		hashTable.emplace(key, format(value));
+		return true;
+	}
+	Entry *read(const string &key) {
+		string entry = raw(key);
+		if ( entry.empty() ) {
+			return NULL;
+		}
+		vector<string> tuple;
+		size_t start = 0;
+		size_t pos = entry.find(":");
+		while ( pos != string::npos ) {
+			tuple.push_back(entry.substr(start, pos - start));
+			start = pos + 1;
+			pos = entry.find(":", start);
+		}
+		tuple.push_back(entry.substr(start));
+		parsed.value = tuple.at(0);
+		parsed.timestamp = stoi(tuple.at(1));
+		parsed.replica = static_cast<ReplicaType>(stoi(tuple.at(2)));
+		return &parsed;
+	}
+	bool update(const string &key, const Entry &newValue) {
+		if ( raw(key).empty() ) {
+			return false;
+		}
+		hashTable.at(key) = format(newValue);
+		return true;
+	}
+	bool deleteKey(const string &key) {
+		if ( raw(key).empty() ) {
+			return false;
+		}
+		return hashTable.erase(key) > 0;
+	}
+};
+
+/**
+ * FUNCTION NAME: runTable
+ *
+ * DESCRIPTION: Creates, reads, misses, updates and deletes every key of keys in a new table,
+ * 				each pass in a different random order, and prints the time per operation and
+ * 				the allocations per key the creates made
+ */
+template<typename Table> static void runTable(const char *name, vector<string> &keys) {
+	vector<string> missing(keys.size());
+	long long ns[5];
+	long found[5] = {0, 0, 0, 0, 0};
+	Table *table = new Table();
+
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		missing[i] = keys[i] + "!";
+	}
+
+	long before = allocations;
+	long long start = nowNs();
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		found[0] += table->create(keys[i], Entry("value0", 100, PRIMARY));
+	}
+	ns[0] = nowNs() - start;
+	long created = allocations - before;
+
+	random_shuffle(keys.begin(), keys.end());
+	start = nowNs();
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		found[1] += table->read(keys[i]) != NULL;
+	}
+	ns[1] = nowNs() - start;
+
+	start = nowNs();
+	for ( unsigned int i = 0; i < missing.size(); i++ ) {
+		found[2] += table->read(missing[i]) != NULL;
+	}
+	ns[2] = nowNs() - start;
+
+	random_shuffle(keys.begin(), keys.end());
+	start = nowNs();
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		found[3] += table->update(keys[i], Entry("value1", 200, PRIMARY));
+	}
+	ns[3] = nowNs() - start;
+
+	random_shuffle(keys.begin(), keys.end());
+	start = nowNs();
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		found[4] += table->deleteKey(keys[i]);
+	}
+	ns[4] = nowNs() - start;
+
+	printf("  %-10s create %6.1f  read %6.1f  miss %6.1f  update %6.1f  delete %6.1f ns/op  %.2f allocs/key  ok %ld %ld %ld %ld %ld\n",
+			name, (double)ns[0] / keys.size(), (double)ns[1] / keys.size(), (double)ns[2] / keys.size(),
+			(double)ns[3] / keys.size(), (double)ns[4] / keys.size(), (double)created / keys.size(),
+			found[0], found[1], found[2], found[3], found[4]);
+
+	delete table;
+}
+
+/**
+ * FUNCTION NAME: benchHashTable
+ *
+ * DESCRIPTION: HashTable's open addressing slots of entries against the std::map of entry
+ * 				strings it replaced, with keys like the ones the tests write
+ */
+static void benchHashTable() {
+	vector<string> keys(BENCH_TABLE_KEYS);
+
+	printf("hashtable: %d keys\n", BENCH_TABLE_KEYS);
+	srand(1);
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		keys[i] = "key" + to_string(i);
+	}
+	runTable<MapTable>("map", keys);
+	runTable<HashTable>("hashtable", keys);
+}
+
+/**
+ * FUNCTION NAME: benchReplicaIndex
+ *
+ * DESCRIPTION: Cost of finding the keys a node holds as secondary, as stabilization does, by
+ * 				walking HashTable's replica list against scanning the whole table into a map
+ * 				as it did before. A third of the keys of each type are deleted, updated and
+ * 				retyped first, and the two must find the same keys.
+ */
+static void benchReplicaIndex() {
+	int sizes[] = {10000, 100000, 1000000};
+
+	printf("replica_index: %d walks, keys held equally as the three types\n", BENCH_INDEX_ROUNDS);
+	srand(1);
+
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		HashTable *table = new HashTable();
+		long long scanNs = 0;
+		long long walkNs = 0;
+		unsigned long scanned = 0;
+		unsigned long walked = 0;
+
+		for ( int i = 0; i < sizes[s]; i++ ) {
+			table->create("key" + to_string(i), Entry("value", 0, static_cast<ReplicaType>(i % HASHTABLE_REPLICAS)));
+		}
+		for ( int i = 0; i < sizes[s] / 3; i++ ) {
+			string key = "key" + to_string(rand() % sizes[s]);
+			switch ( i % 3 ) {
+			case 0:
+				table->deleteKey(key);
+				break;
+			case 1:
+				table->update(key, Entry("value", 1, static_cast<ReplicaType>(rand() % HASHTABLE_REPLICAS)));
+				break;
+			default:
+				table->setReplica(key, static_cast<ReplicaType>(rand() % HASHTABLE_REPLICAS));
+			}
+		}
+
+		for ( int r = 0; r < BENCH_INDEX_ROUNDS; r++ ) {
+			long long start = nowNs();
+			map<string, string> items;
+			table->forEach([&](const string &key, const Entry &entry) {
+				if ( entry.replica == SECONDARY ) {
+					items.emplace(key, entry.value);
+				}
+			});
+			scanNs += nowNs() - start;
+			scanned = items.size();
+
+			start = nowNs();
+			walked = 0;
+			table->forEachOf(SECONDARY, [&](const string &key, const Entry &entry) {
+				walked += entry.replica == SECONDARY && !key.empty();
+			});
+			walkNs += nowNs() - start;
+		}
+
+		// every key is on exactly one list
+		unsigned long listed = 0;
+		for ( int t = 0; t < HASHTABLE_REPLICAS; t++ ) {
+			table->forEachOf(static_cast<ReplicaType>(t), [&](const string &key, const Entry &entry) {
+				listed += entry.replica == t;
+			});
+		}
+
+		printf("  keys %8lu  secondary %7lu  scan %12.1f ns  walk %11.1f ns  %s\n",
+				table->currentSize(), walked, (double)scanNs / BENCH_INDEX_ROUNDS, (double)walkNs / BENCH_INDEX_ROUNDS,
+				scanned == walked && listed == table->currentSize() ? "same keys" : "MISMATCH");
+
+		delete table;
+	}
+}
+
+/**
+ * FUNCTION NAME: runCodec
+ *
+ * DESCRIPTION: Encodes and decodes message BENCH_CODEC_ROUNDS times in the text form and in
+ * 				the binary one, and prints the time per operation and the bytes of each
+ */
+static void runCodec(const char *name, Message &message) {
+	vector<char> buffer(message.encodedSize());
+	MessageView view;
+	string text;
+	long long textEncodeNs, textDecodeNs, binaryEncodeNs, binaryDecodeNs;
+	long checksum = 0;
+
+	long long start = nowNs();
+	for ( int r = 0; r < BENCH_CODEC_ROUNDS; r++ ) {
+		text = message.toString();
+	}
+	textEncodeNs = nowNs() - start;
+
+	// the text parser throws on a field it cannot read
+	bool parses = true;
+	string textValue;
+	try {
+		textValue = Message(text).value;
+	}
+	catch ( const exception &e ) {
+		parses = false;
+	}
+
+	start = nowNs();
+	for ( int r = 0; parses && r < BENCH_CODEC_ROUNDS; r++ ) {
+		Message decoded(text);
+		checksum += decoded.transID;
+	}
+	textDecodeNs = nowNs() - start;
+
+	start = nowNs();
+	for ( int r = 0; r < BENCH_CODEC_ROUNDS; r++ ) {
+		checksum += message.encode(&buffer[0], buffer.size());
+	}
+	binaryEncodeNs = nowNs() - start;
+
+	start = nowNs();
+	for ( int r = 0; r < BENCH_CODEC_ROUNDS; r++ ) {
+		checksum += Message::decode(&buffer[0], buffer.size(), view) ? view.transID : -1;
+	}
+	binaryDecodeNs = nowNs() - start;
+
+	// the value comes back whole only if the format does not read into it
+	string binaryValue(view.value, view.valueSize);
+	printf("  %-10s text %5d B  encode %7.1f  decode %7.1f ns/op  %s   binary %5d B  encode %6.1f  decode %6.1f ns/op  %s\n",
+			name, (int)text.size(), (double)textEncodeNs / BENCH_CODEC_ROUNDS, (double)textDecodeNs / BENCH_CODEC_ROUNDS,
+			!parses ? "does not parse" : textValue == message.value ? "round trip ok " : "value broken  ",
+			message.encodedSize(), (double)binaryEncodeNs / BENCH_CODEC_ROUNDS, (double)binaryDecodeNs / BENCH_CODEC_ROUNDS,
+			binaryValue == message.value && checksum != 0 ? "round trip ok" : "value broken");
+}
+
+/**
+ * FUNCTION NAME: benchMessageCodec
+ *
+ * DESCRIPTION: MP2's binary message format against the "::" separated text, for the messages
+ * 				the tests send, a large value, and a value holding the text separator
+ */
+static void benchMessageCodec() {
+	Address addr;
+	int id = 7;
+	short port = 0;
+
+	memcpy(&addr.addr[0], &id, sizeof(int));
+	memcpy(&addr.addr[4], &port, sizeof(short));
+	printf("message_codec: %d rounds\n", BENCH_CODEC_ROUNDS);
+
+	Message create(1234, addr, CREATE, "Q9dHw", "value39", SECONDARY);
+	Message read(1234, addr, READ, "Q9dHw");
+	Message reply(1234, addr, REPLY, true);
+	Message readReply(1234, addr, string("value39"));
+	Message large(1234, addr, UPDATE, "Q9dHw", string(1000, 'v'), PRIMARY);
+	Message separator(1234, addr, CREATE, "Q9dHw", "a::b", PRIMARY);
+	runCodec("create", create);
+	runCodec("read", read);
+	runCodec("reply", reply);
+	runCodec("readreply", readReply);
+	runCodec("1 KB value", large);
+	runCodec("\"::\" value", separator);
+
+	// a binary message cut short is still told apart from text, so checkMessages drops it instead of parsing it
+	vector<char> buffer(create.encodedSize());
+	MessageView view;
+	int misread = 0;
+	create.encode(&buffer[0], buffer.size());
+	for ( int size = 1; size < (int)buffer.size(); size++ ) {
+		if ( !Message::isBinary(&buffer[0], size) || Message::decode(&buffer[0], size, view) ) {
+			misread++;
+		}
+	}
+	printf("  create cut short at every length: %d misread  %s\n", misread, misread == 0 ? "ok" : "FAILED");
+	if ( misread != 0 ) {
+		checksFailed = true;
+	}
+}
+
+/**
+ * FUNCTION NAME: linearFindNodes
+ *
+ * DESCRIPTION: The replica lookup findNodes made before the ring kept a token array: a walk
+ * 				from the start of the ring copying the nodes it returns
+ */
+static vector<Node> linearFindNodes(vector<Node> &ring, size_t pos) {
+	vector<Node> addr_vec;
+	if (ring.size() >= 3) {
+		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
+			addr_vec.emplace_back(ring.at(0));
+			addr_vec.emplace_back(ring.at(1));
+			addr_vec.emplace_back(ring.at(2));
+		}
+		else {
+			for (unsigned int i=1; i<ring.size(); i++){
+				Node addr = ring.at(i);
+				if (pos <= addr.getHashCode()) {
+					addr_vec.emplace_back(addr);
+					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
+					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
+					break;
+				}
+			}
+		}
+	}
+	return addr_vec;
+}
+
+/**
+ * FUNCTION NAME: benchRingLookup
+ *
+ * DESCRIPTION: Cost of finding the replicas of a key with the binary search over the ring's
+ * 				token array against the linear walk it replaced, on rings of growing size.
+ * 				The two must pick the same nodes.
+ */
+static void benchRingLookup() {
+	int sizes[] = {10, 100, 1000, 10000};
+	vector<LogRecord> discarded;
+	vector<size_t> positions(BENCH_LOOKUP_KEYS);
+
+	printf("ring_lookup: %d keys\n", BENCH_LOOKUP_KEYS);
+	srand(1);
+	for ( unsigned int k = 0; k < positions.size(); k++ ) {
+		positions[k] = rand() % RING_SIZE;
+	}
+
+	for ( unsigned int s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ ) {
+		int numMembers = sizes[s];
+		Params *par = new Params();
+		initBenchParams(par, numMembers + 1);
+		EmulNet *en = new EmulNet(par);
+		Log *log = new Log(par);
+		Member *member = new Member();
+		Address addr;
+		int replicas[REPLICA_COUNT];
+		long mismatches = 0;
+		long checksum = 0;
+
+		en->ENinit(&addr, par->PORTNUM);
+		MP1Node *node = new MP1Node(member, par, en, log, &addr);
+		// the ring owns member from here on
+		MP2Node *ring = new MP2Node(member, par, en, log, &addr);
+		node->initThisNode(&addr);
+		member->inGroup = true;
+
+		Log::beginCapture(&discarded);
+		vector<char> msg = buildGossip(numMembers, 0);
+		node->recvCallBack(member, &msg[0], msg.size());
+		ring->updateRing();
+		Log::endCapture();
+
+		// the ring as the walk saw it, in the order MP2 inserted the members
+		vector<Node> nodes;
+		for ( unsigned int i = 0; i < member->memberList.size(); i++ ) {
+			Address memberAddress;
+			memcpy(&memberAddress.addr[0], &member->memberList[i].id, sizeof(int));
+			memcpy(&memberAddress.addr[4], &member->memberList[i].port, sizeof(short));
+			nodes.emplace_back(Node(memberAddress));
+		}
+		stable_sort(nodes.begin(), nodes.end());
+
+		long long start = nowNs();
+		for ( unsigned int k = 0; k < positions.size(); k++ ) {
+			checksum += ring->findReplicas(positions[k], replicas) + replicas[0];
+		}
+		long long searchNs = nowNs() - start;
+
+		start = nowNs();
+		for ( unsigned int k = 0; k < positions.size(); k++ ) {
+			vector<Node> found = linearFindNodes(nodes, positions[k]);
+			checksum += found.size();
+		}
+		long long walkNs = nowNs() - start;
+
+		for ( unsigned int k = 0; k < positions.size(); k++ ) {
+			vector<Node> found = linearFindNodes(nodes, positions[k]);
+			int count = ring->findReplicas(positions[k], replicas);
+			for ( int i = 0; i < count; i++ ) {
+				mismatches += !(*found[i].getAddress() == *nodes[replicas[i]].getAddress());
+			}
+		}
+
+		printf("  nodes %6d  search %7.1f ns/lookup  walk %9.1f ns/lookup  %s\n",
+				(int)nodes.size(), (double)searchNs / positions.size(), (double)walkNs / positions.size(),
+				mismatches == 0 && checksum != 0 ? "same replicas" : "MISMATCH");
+
+		delete ring;
+		delete node;
+		delete log;
+		delete en;
+		delete par;
+		discarded.clear();
+	}
+}
+
+/**
+ * Benchmark table
+ */
+typedef struct BenchEntry {
+	const char *name;
+	void (*run)();
+} BenchEntry;
+
+static BenchEntry benchmarks[] = {
+	{"emulnet_recv", benchEmulNetRecv},
+	{"transport", benchTransport},
+	{"membership_merge", benchMembershipMerge},
+	{"failure_detection", benchFailureDetection},
+	{"timer_wheel", benchTimerWheel},
+	{"ring_update", benchRingUpdate},
+	{"wire_format", benchWireFormat},
+	{"detector", benchDetector},
+	{"digest", benchDigest},
+	{"ring", benchRing},
+	{"view", benchView},
+	{"hashtable", benchHashTable},
+	{"replica_index", benchReplicaIndex},
+	{"message_codec", benchMessageCodec},
+	{"ring_lookup", benchRingLookup},
+	{"mp1_soak", benchMp1Soak},
+};
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: Runs the benchmark named on the command line, or all of them
+ **********************************/
+int main(int argc, char *argv[]) {
+	bool found = false;
+
+	for ( unsigned int i = 0; i < sizeof(benchmarks)/sizeof(benchmarks[0]); i++ ) {
+		if ( argc < 2 || 0 == strcmp(argv[1], benchmarks[i].name) ) {
+			benchmarks[i].run();
+			found = true;
+		}
+	}
+
+	if ( !found ) {
+		cout<<"Unknown benchmark "<<argv[1]<<endl;
+		return FAILURE;
+	}
+	if ( checksFailed ) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
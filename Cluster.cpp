@@ -0,0 +1,409 @@
+/**********************************
+ * FILE NAME: Cluster.cpp
+ *
+ * DESCRIPTION: Multi-process cluster mode definition
+ **********************************/
+
+#include "Cluster.h"
+#include "Log.h"
+
+/**
+ * FUNCTION NAME: recordLength
+ *
+ * DESCRIPTION: Bytes a message of the given size takes in a ring, kept 8 byte aligned
+ */
+static unsigned long recordLength(int size) {
+	return (sizeof(shm_record) + size + 7) & ~7UL;
+}
+
+/**
+ * Constructor
+ *
+ * Maps the control block and all the rings in one shared anonymous mapping,
+ * which the workers inherit across the fork.
+ */
+Cluster::Cluster(Params *p) {
+	size_t ctlSize = (sizeof(cluster_ctl) + 4095) & ~(size_t)4095;
+
+	this->par = p;
+	this->workers = p->PROCESSES;
+	this->worker = -1;
+	this->localSense = 0;
+	this->regionSize = ctlSize + (size_t)CLUSTER_NETS * workers * workers * sizeof(shm_ring);
+
+	region = (char *)mmap(NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if ( region == MAP_FAILED ) {
+		perror("Cluster mmap");
+		exit(1);
+	}
+	ctl = (cluster_ctl *)region;
+	rings = (shm_ring *)(region + ctlSize);
+}
+
+/**
+ * Destructor
+ */
+Cluster::~Cluster() {
+	munmap(region, regionSize);
+}
+
+/**
+ * FUNCTION NAME: workerDir
+ *
+ * DESCRIPTION: Directory worker w writes its logs in
+ */
+string Cluster::workerDir(int w) {
+	return CLUSTER_DIR + to_string(w);
+}
+
+/**
+ * FUNCTION NAME: start
+ *
+ * DESCRIPTION: Forks the workers. Each worker moves into its own directory so that its
+ * 				dbg.log, stats.log and msgcount.log do not collide with the others.
+ *
+ * RETURNS:
+ * true in a worker, false in the launcher
+ */
+bool Cluster::start() {
+	// Anything still buffered would be printed once per process
+	cout.flush();
+	fflush(stdout);
+
+	for ( int w = 0; w < workers; w++ ) {
+		mkdir(workerDir(w).c_str(), 0755);
+		pid_t pid = fork();
+		if ( pid < 0 ) {
+			perror("Cluster fork");
+			exit(1);
+		}
+		if ( pid == 0 ) {
+			worker = w;
+			if ( chdir(workerDir(w).c_str()) != 0 ) {
+				perror("Cluster chdir");
+				exit(1);
+			}
+			return true;
+		}
+		pids.push_back(pid);
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: supervise
+ *
+ * DESCRIPTION: Waits for the workers and merges their logs. A worker that dies or exits
+ * 				with an error would leave the others waiting at the barrier forever, so the
+ * 				rest of the cluster is stopped as soon as that happens.
+ *
+ * RETURNS:
+ * SUCCESS if every worker finished cleanly
+ */
+int Cluster::supervise() {
+	int status;
+	bool failed = false;
+
+	for ( int remaining = workers; remaining > 0; remaining-- ) {
+		pid_t pid = wait(&status);
+		if ( pid < 0 ) {
+			break;
+		}
+		if ( !failed && (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ) {
+			int w = find(pids.begin(), pids.end(), pid) - pids.begin();
+			cout<<"Worker "<<w<<" failed, stopping the cluster"<<endl;
+			for ( unsigned int i = 0; i < pids.size(); i++ ) {
+				if ( pids[i] != pid ) {
+					kill(pids[i], SIGKILL);
+				}
+			}
+			failed = true;
+		}
+	}
+
+	mergeLog(DBG_LOG, true);
+	mergeLog(STATS_LOG, false);
+	mergeMsgCount();
+
+	if ( !failed ) {
+		for ( int w = 0; w < workers; w++ ) {
+			unlink((workerDir(w) + "/" + DBG_LOG).c_str());
+			unlink((workerDir(w) + "/" + STATS_LOG).c_str());
+			unlink((workerDir(w) + "/msgcount.log").c_str());
+			rmdir(workerDir(w).c_str());
+		}
+	}
+
+	return failed ? FAILURE : SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: mergeLog
+ *
+ * DESCRIPTION: Merges the workers' copies of a Log file by tick. Entries of one tick keep
+ * 				the order of the worker indices, and each worker's own order within them.
+ * 				magic tells whether the files start with the dbg.log header line.
+ */
+void Cluster::mergeLog(const char *name, bool magic) {
+	vector< pair<int, string> > entries;
+	string header;
+	string line;
+	FILE *out;
+
+	for ( int w = 0; w < workers; w++ ) {
+		ifstream in((workerDir(w) + "/" + name).c_str());
+		bool first = true;
+		int time = 0;
+
+		while ( getline(in, line) ) {
+			if ( magic && first ) {
+				header = line;
+				first = false;
+				continue;
+			}
+			if ( line.empty() ) {
+				continue;
+			}
+			// " a.b.c.d:port [time] text"; a line without a time stays with the one before it
+			sscanf(line.c_str(), " %*s [%d]", &time);
+			entries.push_back(make_pair(time, line));
+		}
+	}
+	stable_sort(entries.begin(), entries.end(),
+			[](const pair<int, string> &a, const pair<int, string> &b) { return a.first < b.first; });
+
+	out = fopen(name, "w");
+	if ( out == NULL ) {
+		return;
+	}
+	if ( magic ) {
+		fprintf(out, "%s\n", header.c_str());
+	}
+	for ( unsigned int i = 0; i < entries.size(); i++ ) {
+		fprintf(out, "\n%s", entries[i].second.c_str());
+	}
+	fclose(out);
+}
+
+/**
+ * FUNCTION NAME: mergeMsgCount
+ *
+ * DESCRIPTION: Builds msgcount.log from the rows of each node's own worker
+ * 				and the summed allocation counts
+ */
+void Cluster::mergeMsgCount() {
+	vector< vector<string> > blocks(workers);
+	long allocations = 0;
+	long delivered = 0;
+	FILE *out;
+
+	for ( int w = 0; w < workers; w++ ) {
+		ifstream in((workerDir(w) + "/msgcount.log").c_str());
+		string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		size_t begin = 0;
+		size_t end;
+
+		// One block per node, separated by an empty line, then the allocation counts
+		while ( (end = text.find("\n\n", begin)) != string::npos ) {
+			blocks[w].push_back(text.substr(begin, end - begin));
+			begin = end + 2;
+		}
+		long a = 0, d = 0;
+		if ( sscanf(text.c_str() + begin, "allocations %ld delivered %ld", &a, &d) == 2 ) {
+			allocations += a;
+			delivered += d;
+		}
+	}
+
+	out = fopen("msgcount.log", "w+");
+	if ( out == NULL ) {
+		return;
+	}
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		vector<string> &own = blocks[owner(i)];
+		if ( i < (int)own.size() ) {
+			fprintf(out, "%s\n\n", own[i].c_str());
+		}
+	}
+	fprintf(out, "allocations %ld  delivered %ld  allocations/delivered %.2f\n", allocations, delivered, delivered ? (double)allocations / delivered : 0.0);
+	fclose(out);
+}
+
+/**
+ * FUNCTION NAME: getWorker
+ *
+ * DESCRIPTION: Index of this worker, -1 in the launcher
+ */
+int Cluster::getWorker() {
+	return worker;
+}
+
+/**
+ * FUNCTION NAME: getWorkers
+ */
+int Cluster::getWorkers() {
+	return workers;
+}
+
+/**
+ * FUNCTION NAME: owner
+ *
+ * DESCRIPTION: Worker hosting the node with the given index (not id) in mp1[]/mp2[]
+ */
+int Cluster::owner(int index) {
+	return index * workers / par->EN_GPSZ;
+}
+
+/**
+ * FUNCTION NAME: owns
+ *
+ * DESCRIPTION: Whether this worker hosts the node with the given index
+ */
+bool Cluster::owns(int index) {
+	return owner(index) == worker;
+}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Sense reversing barrier over all the workers. The last one to arrive
+ * 				flips the shared sense, which releases the others.
+ */
+void Cluster::barrier() {
+	localSense = !localSense;
+	if ( __atomic_add_fetch(&ctl->arrived, 1, __ATOMIC_ACQ_REL) == workers ) {
+		__atomic_store_n(&ctl->arrived, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&ctl->sense, localSense, __ATOMIC_RELEASE);
+	}
+	else {
+		while ( __atomic_load_n(&ctl->sense, __ATOMIC_ACQUIRE) != localSense ) {
+			sched_yield();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: ring
+ *
+ * DESCRIPTION: Ring carrying network net's messages from worker from to worker to
+ */
+shm_ring *Cluster::ring(int net, int from, int to) {
+	return &rings[(net * workers + from) * workers + to];
+}
+
+/**
+ * FUNCTION NAME: ringPush
+ *
+ * DESCRIPTION: Appends a message to a ring. Only the producing worker calls this.
+ *
+ * RETURNS:
+ * false if the ring is full and the message was not written
+ */
+bool Cluster::ringPush(shm_ring *r, int time, Address *from, Address *to, char *data, int size) {
+	unsigned long head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	unsigned long tail = r->tail;
+	unsigned long len = recordLength(size);
+	unsigned long offset = tail % SHM_RING_SIZE;
+	unsigned long room = SHM_RING_SIZE - offset;
+	unsigned long need = (room < len) ? room + len : len;
+	shm_record *rec;
+
+	if ( SHM_RING_SIZE - (tail - head) < need ) {
+		return false;
+	}
+	// A record never wraps; skip the end of the ring instead
+	if ( room < len ) {
+		if ( room >= sizeof(shm_record) ) {
+			((shm_record *)(r->data + offset))->size = -1;
+		}
+		tail += room;
+		offset = 0;
+	}
+
+	rec = (shm_record *)(r->data + offset);
+	rec->time = time;
+	rec->size = size;
+	memcpy(rec->from, from->addr, sizeof(rec->from));
+	memcpy(rec->to, to->addr, sizeof(rec->to));
+	memcpy(rec + 1, data, size);
+
+	__atomic_store_n(&r->tail, tail + len, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: ringPeek
+ *
+ * DESCRIPTION: Oldest message of a ring, NULL if it is empty. Only the consuming worker calls this.
+ */
+shm_record *Cluster::ringPeek(shm_ring *r) {
+	unsigned long tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	unsigned long head = r->head;
+	unsigned long offset;
+	unsigned long room;
+
+	if ( head == tail ) {
+		return NULL;
+	}
+	offset = head % SHM_RING_SIZE;
+	room = SHM_RING_SIZE - offset;
+	if ( room < sizeof(shm_record) || ((shm_record *)(r->data + offset))->size == -1 ) {
+		head += room;
+		__atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+		if ( head == tail ) {
+			return NULL;
+		}
+		offset = 0;
+	}
+	return (shm_record *)(r->data + offset);
+}
+
+/**
+ * FUNCTION NAME: ringPop
+ *
+ * DESCRIPTION: Drops the message ringPeek returned
+ */
+void Cluster::ringPop(shm_ring *r) {
+	shm_record *rec = (shm_record *)(r->data + r->head % SHM_RING_SIZE);
+	__atomic_store_n(&r->head, r->head + recordLength(rec->size), __ATOMIC_RELEASE);
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Adds a driver command for the current tick. Only worker 0 calls this.
+ */
+void Cluster::post(int type, int node, string key, string value) {
+	assert(ctl->numCmds < CLUSTER_MAX_CMDS);
+	assert(key.length() < CLUSTER_STRLEN && value.length() < CLUSTER_STRLEN);
+
+	cluster_cmd *cmd = &ctl->cmds[ctl->numCmds];
+	cmd->type = type;
+	cmd->node = node;
+	strcpy(cmd->key, key.c_str());
+	strcpy(cmd->value, value.c_str());
+	ctl->numCmds++;
+}
+
+/**
+ * FUNCTION NAME: getNumCmds
+ */
+int Cluster::getNumCmds() {
+	return ctl->numCmds;
+}
+
+/**
+ * FUNCTION NAME: getCmd
+ */
+cluster_cmd *Cluster::getCmd(int i) {
+	return &ctl->cmds[i];
+}
+
+/**
+ * FUNCTION NAME: clearCmds
+ *
+ * DESCRIPTION: Empties the command list once every worker is past it
+ */
+void Cluster::clearCmds() {
+	ctl->numCmds = 0;
+}
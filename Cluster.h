@@ -0,0 +1,131 @@
+/**********************************
+ * FILE NAME: Cluster.h
+ *
+ * DESCRIPTION: Multi-process cluster mode header file
+ **********************************/
+
+#ifndef _CLUSTER_H_
+#define _CLUSTER_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sched.h>
+
+/*
+ * Macros
+ */
+// bytes of every ring, a multiple of 8
+#define SHM_RING_SIZE (1 << 20)
+// networks carried by the rings, MP1's and MP2's
+#define CLUSTER_NETS 2
+// driver commands per tick
+#define CLUSTER_MAX_CMDS 1024
+#define CLUSTER_STRLEN 64
+#define CLUSTER_DIR "cluster."
+
+/**
+ * Struct Name: shm_ring
+ *
+ * DESCRIPTION: Single producer, single consumer byte ring in shared memory.
+ * 				head and tail only ever grow; the offset in data is the value modulo SHM_RING_SIZE.
+ */
+typedef struct shm_ring {
+	// advanced by the consumer
+	unsigned long head;
+	char pad1[56];
+	// advanced by the producer
+	unsigned long tail;
+	char pad2[56];
+	char data[SHM_RING_SIZE];
+}shm_ring;
+
+/**
+ * Struct Name: shm_record
+ *
+ * DESCRIPTION: Header of one message in a ring, followed by size bytes of payload.
+ * 				A size of -1 marks the unused end of the ring before a wrap.
+ */
+typedef struct shm_record {
+	// tick the message was sent in
+	int time;
+	int size;
+	char from[6];
+	char to[6];
+}shm_record;
+
+enum clusterCMD { CMD_FAIL, CMD_CREATE, CMD_READ, CMD_UPDATE, CMD_DELETE };
+
+/**
+ * Struct Name: cluster_cmd
+ *
+ * DESCRIPTION: One decision of the test driver, carried out by the worker owning the node
+ */
+typedef struct cluster_cmd {
+	int type;
+	int node;
+	char key[CLUSTER_STRLEN];
+	char value[CLUSTER_STRLEN];
+}cluster_cmd;
+
+/**
+ * Struct Name: cluster_ctl
+ *
+ * DESCRIPTION: Shared control block: the tick barrier and the driver's commands of the current tick
+ */
+typedef struct cluster_ctl {
+	int arrived;
+	int sense;
+	int numCmds;
+	cluster_cmd cmds[CLUSTER_MAX_CMDS];
+}cluster_ctl;
+
+/**
+ * CLASS NAME: Cluster
+ *
+ * DESCRIPTION: Runs the nodes in PROCESSES forked worker processes. Worker w hosts a
+ * 				contiguous slice of the node indices. The workers exchange messages through
+ * 				one ring per (network, sender, receiver) triple and step virtual time
+ * 				together through a shared barrier. Each worker writes its logs in its own
+ * 				directory, and the launcher merges them into the usual files once all are done.
+ */
+class Cluster {
+private:
+	Params *par;
+	int workers;
+	// index of this process, -1 in the launcher
+	int worker;
+	int localSense;
+	vector<pid_t> pids;
+	// the shared mapping, set up before the fork
+	char *region;
+	size_t regionSize;
+	cluster_ctl *ctl;
+	shm_ring *rings;
+	string workerDir(int w);
+	void mergeLog(const char *name, bool magic);
+	void mergeMsgCount();
+public:
+	Cluster(Params *p);
+	virtual ~Cluster();
+	bool start();
+	int supervise();
+	int getWorker();
+	int getWorkers();
+	int owner(int index);
+	bool owns(int index);
+	void barrier();
+	shm_ring *ring(int net, int from, int to);
+	static bool ringPush(shm_ring *r, int time, Address *from, Address *to, char *data, int size);
+	static shm_record *ringPeek(shm_ring *r);
+	static void ringPop(shm_ring *r);
+	void post(int type, int node, string key, string value);
+	int getNumCmds();
+	cluster_cmd *getCmd(int i);
+	void clearCmds();
+};
+
+#endif /* _CLUSTER_H_ */
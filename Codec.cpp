@@ -0,0 +1,410 @@
+/**********************************
+ * FILE NAME: Codec.cpp
+ *
+ * DESCRIPTION: Compact wire format of the membership messages definition
+ **********************************/
+
+#include "Codec.h"
+
+/**
+ * FUNCTION NAME: putVarint
+ *
+ * DESCRIPTION: Appends value as an unsigned LEB128 varint, seven bits per byte, low bits first
+ */
+void Codec::putVarint(vector<char> &out, unsigned long value) {
+	while ( value >= 0x80 ) {
+		out.push_back((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+
+/**
+ * FUNCTION NAME: getVarint
+ *
+ * DESCRIPTION: Reads a varint at p and moves p past it
+ *
+ * RETURNS:
+ * false if the varint runs past end or is too long
+ */
+bool Codec::getVarint(const char *&p, const char *end, unsigned long &value) {
+	value = 0;
+	for ( int shift = 0; shift < 7 * VARINT_MAX; shift += 7 ) {
+		if ( p >= end ) {
+			return false;
+		}
+		unsigned char byte = *p++;
+		value |= (unsigned long)(byte & 0x7f) << shift;
+		if ( !(byte & 0x80) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: varintSize
+ *
+ * DESCRIPTION: Bytes putVarint writes for value
+ */
+int Codec::varintSize(unsigned long value) {
+	int size = 1;
+	while ( value >= 0x80 ) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+/**
+ * FUNCTION NAME: isFrame
+ *
+ * DESCRIPTION: Whether data is a compact frame of any version
+ */
+bool Codec::isFrame(const char *data, int size) {
+	return size >= 2 && ((unsigned char)data[0] & 0xf0) == WIRE_MAGIC;
+}
+
+/**
+ * FUNCTION NAME: encodeMembers
+ *
+ * DESCRIPTION: Encodes entries into as many frames of at most maxBytes as they need.
+ * 				Entry sizes are bounded with the smallest heartbeat of the whole list,
+ * 				which no frame's own base is below, so every frame stays within maxBytes.
+ * 				entries is sorted in place. The frames go to the front of frames; the
+ * 				vectors past them are kept from earlier calls, so that their buffers
+ * 				are reused instead of allocated again.
+ *
+ * RETURNS:
+ * the number of frames
+ */
+int Codec::encodeMembers(int type, Address *sender, vector<WireEntry> &entries, int maxBytes, vector< vector<char> > &frames) {
+	int senderId;
+	short senderPort;
+	unsigned long lowest = 0;
+	unsigned int begin = 0;
+	int count = 0;
+
+	sort(entries.begin(), entries.end(), [](const WireEntry &a, const WireEntry &b) {
+		return a.id < b.id || (a.id == b.id && (unsigned short)a.port < (unsigned short)b.port);
+	});
+	memcpy(&senderId, &sender->addr[0], sizeof(int));
+	memcpy(&senderPort, &sender->addr[4], sizeof(short));
+	for ( unsigned int i = 0; i < entries.size(); i++ ) {
+		lowest = i == 0 ? entries[i].heartbeat : min(lowest, (unsigned long)entries[i].heartbeat);
+	}
+
+	do {
+		// header, with room for the largest count and base
+		int used = 2 + varintSize((unsigned int)senderId) + varintSize((unsigned short)senderPort) + 2 * VARINT_MAX;
+		unsigned int end = begin;
+		int previous = 0;
+		unsigned long base = 0;
+
+		while ( end < entries.size() ) {
+			int size = varintSize((unsigned int)(entries[end].id - (end == begin ? 0 : previous))) +
+					varintSize((unsigned short)entries[end].port) + varintSize(entries[end].heartbeat - lowest);
+			if ( end > begin && used + size > maxBytes ) {
+				break;
+			}
+			used += size;
+			previous = entries[end].id;
+			base = end == begin ? entries[end].heartbeat : min(base, (unsigned long)entries[end].heartbeat);
+			end++;
+		}
+
+		if ( count == (int)frames.size() ) {
+			frames.push_back(vector<char>());
+		}
+		vector<char> &frame = frames[count++];
+		frame.clear();
+		frame.push_back((char)(WIRE_MAGIC | WIRE_VERSION));
+		frame.push_back((char)type);
+		putVarint(frame, (unsigned int)senderId);
+		putVarint(frame, (unsigned short)senderPort);
+		putVarint(frame, end - begin);
+		putVarint(frame, base);
+		previous = 0;
+		for ( unsigned int i = begin; i < end; i++ ) {
+			putVarint(frame, (unsigned int)(entries[i].id - previous));
+			putVarint(frame, (unsigned short)entries[i].port);
+			putVarint(frame, entries[i].heartbeat - base);
+			previous = entries[i].id;
+		}
+		begin = end;
+	} while ( begin < entries.size() );
+	return count;
+}
+
+/**
+ * FUNCTION NAME: decodeMembers
+ *
+ * DESCRIPTION: Decodes one frame
+ *
+ * RETURNS:
+ * false if data is not a well formed frame of a known version
+ */
+bool Codec::decodeMembers(const char *data, int size, int &type, Address *sender, vector<WireEntry> &entries) {
+	const char *p = data + 2;
+	const char *end = data + size;
+	unsigned long senderId, senderPort, count, base;
+
+	if ( !isFrame(data, size) || ((unsigned char)data[0] & 0x0f) != WIRE_VERSION ) {
+		return false;
+	}
+	type = (unsigned char)data[1];
+	if ( !getVarint(p, end, senderId) || !getVarint(p, end, senderPort) || !getVarint(p, end, count) || !getVarint(p, end, base) ) {
+		return false;
+	}
+	int id = senderId;
+	short port = senderPort;
+	memcpy(&sender->addr[0], &id, sizeof(int));
+	memcpy(&sender->addr[4], &port, sizeof(short));
+
+	// every entry takes at least three bytes
+	if ( count > (unsigned long)(end - p) / 3 ) {
+		return false;
+	}
+	entries.resize(count);
+	unsigned long previous = 0;
+	for ( unsigned long i = 0; i < count; i++ ) {
+		unsigned long idDelta, entryPort, heartbeat;
+		if ( !getVarint(p, end, idDelta) || !getVarint(p, end, entryPort) || !getVarint(p, end, heartbeat) ) {
+			return false;
+		}
+		previous += idDelta;
+		entries[i].id = previous;
+		entries[i].port = entryPort;
+		entries[i].heartbeat = base + heartbeat;
+	}
+	return p == end;
+}
+
+/**
+ * FUNCTION NAME: frameType
+ *
+ * DESCRIPTION: Message type of a frame isFrame accepted
+ */
+int Codec::frameType(const char *data) {
+	return (unsigned char)data[1];
+}
+
+/**
+ * FUNCTION NAME: encodeDigest
+ *
+ * DESCRIPTION: Encodes words into one digest frame, replacing the contents of frame
+ */
+void Codec::encodeDigest(int type, Address *sender, vector<unsigned int> &words, vector<char> &frame) {
+	int senderId;
+	short senderPort;
+
+	memcpy(&senderId, &sender->addr[0], sizeof(int));
+	memcpy(&senderPort, &sender->addr[4], sizeof(short));
+	frame.clear();
+	frame.push_back((char)(WIRE_MAGIC | WIRE_VERSION));
+	frame.push_back((char)type);
+	putVarint(frame, (unsigned int)senderId);
+	putVarint(frame, (unsigned short)senderPort);
+	putVarint(frame, words.size());
+	for ( unsigned int i = 0; i < words.size(); i++ ) {
+		for ( int shift = 0; shift < 32; shift += 8 ) {
+			frame.push_back((char)((words[i] >> shift) & 0xff));
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: decodeDigest
+ *
+ * DESCRIPTION: Decodes one digest frame
+ *
+ * RETURNS:
+ * false if data is not a well formed digest frame of a known version
+ */
+bool Codec::decodeDigest(const char *data, int size, int &type, Address *sender, vector<unsigned int> &words) {
+	const char *p = data + 2;
+	const char *end = data + size;
+	unsigned long senderId, senderPort, count;
+
+	if ( !isFrame(data, size) || ((unsigned char)data[0] & 0x0f) != WIRE_VERSION ) {
+		return false;
+	}
+	type = (unsigned char)data[1];
+	if ( !getVarint(p, end, senderId) || !getVarint(p, end, senderPort) || !getVarint(p, end, count) ) {
+		return false;
+	}
+	int id = senderId;
+	short port = senderPort;
+	memcpy(&sender->addr[0], &id, sizeof(int));
+	memcpy(&sender->addr[4], &port, sizeof(short));
+
+	if ( count != (unsigned long)(end - p) / 4 || (end - p) % 4 != 0 ) {
+		return false;
+	}
+	words.resize(count);
+	for ( unsigned long i = 0; i < count; i++ ) {
+		words[i] = 0;
+		for ( int shift = 0; shift < 32; shift += 8 ) {
+			words[i] |= (unsigned int)(unsigned char)*p++ << shift;
+		}
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: putAddress
+ *
+ * DESCRIPTION: Appends the id and the port of a six byte address
+ */
+void Codec::putAddress(vector<char> &out, const char *addr) {
+	int id;
+	short port;
+
+	memcpy(&id, &addr[0], sizeof(int));
+	memcpy(&port, &addr[4], sizeof(short));
+	putVarint(out, (unsigned int)id);
+	putVarint(out, (unsigned short)port);
+}
+
+/**
+ * FUNCTION NAME: getAddress
+ *
+ * DESCRIPTION: Reads an address putAddress wrote at p into a six byte address and moves p past it
+ *
+ * RETURNS:
+ * false if it runs past end
+ */
+bool Codec::getAddress(const char *&p, const char *end, char *addr) {
+	unsigned long id, port;
+
+	if ( !getVarint(p, end, id) || !getVarint(p, end, port) ) {
+		return false;
+	}
+	int addrId = id;
+	short addrPort = port;
+	memcpy(&addr[0], &addrId, sizeof(int));
+	memcpy(&addr[4], &addrPort, sizeof(short));
+	return true;
+}
+
+/**
+ * FUNCTION NAME: encodeSwim
+ *
+ * DESCRIPTION: Encodes a SWIM message and its updates into one frame, replacing the contents of frame
+ */
+void Codec::encodeSwim(SwimMessage &msg, vector<SwimUpdate> &updates, vector<char> &frame) {
+	frame.clear();
+	frame.push_back((char)(WIRE_MAGIC | WIRE_VERSION));
+	frame.push_back((char)msg.type);
+	putVarint(frame, (unsigned int)msg.seq);
+	putAddress(frame, msg.origin);
+	putAddress(frame, msg.target);
+	putAddress(frame, msg.relay);
+	putVarint(frame, updates.size());
+	for ( unsigned int i = 0; i < updates.size(); i++ ) {
+		putVarint(frame, (unsigned int)updates[i].id);
+		putVarint(frame, (unsigned short)updates[i].port);
+		putVarint(frame, (unsigned short)updates[i].state);
+		putVarint(frame, (unsigned long)updates[i].incarnation);
+	}
+}
+
+/**
+ * FUNCTION NAME: decodeSwim
+ *
+ * DESCRIPTION: Decodes one SWIM frame
+ *
+ * RETURNS:
+ * false if data is not a well formed SWIM frame of a known version
+ */
+bool Codec::decodeSwim(const char *data, int size, SwimMessage &msg, vector<SwimUpdate> &updates) {
+	const char *p = data + 2;
+	const char *end = data + size;
+	unsigned long seq, count;
+
+	if ( !isFrame(data, size) || ((unsigned char)data[0] & 0x0f) != WIRE_VERSION ) {
+		return false;
+	}
+	msg.type = (unsigned char)data[1];
+	if ( !getVarint(p, end, seq) || !getAddress(p, end, msg.origin) || !getAddress(p, end, msg.target) ||
+			!getAddress(p, end, msg.relay) || !getVarint(p, end, count) ) {
+		return false;
+	}
+	msg.seq = seq;
+
+	// every update takes at least four bytes
+	if ( count > (unsigned long)(end - p) / 4 ) {
+		return false;
+	}
+	updates.resize(count);
+	for ( unsigned long i = 0; i < count; i++ ) {
+		unsigned long id, port, state, incarnation;
+		if ( !getVarint(p, end, id) || !getVarint(p, end, port) || !getVarint(p, end, state) || !getVarint(p, end, incarnation) ) {
+			return false;
+		}
+		updates[i].id = id;
+		updates[i].port = port;
+		updates[i].state = state;
+		updates[i].incarnation = incarnation;
+	}
+	return p == end;
+}
+
+/**
+ * FUNCTION NAME: encodeView
+ *
+ * DESCRIPTION: Encodes a HYPARVIEW message and its count keys into one frame, replacing the contents of frame
+ */
+void Codec::encodeView(ViewMessage &msg, const long *keys, int count, vector<char> &frame) {
+	frame.clear();
+	frame.push_back((char)(WIRE_MAGIC | WIRE_VERSION));
+	frame.push_back((char)msg.type);
+	putVarint(frame, (unsigned int)msg.ttl);
+	putVarint(frame, (unsigned int)msg.flag);
+	putVarint(frame, (unsigned long)msg.sender);
+	putVarint(frame, (unsigned long)msg.origin);
+	putVarint(frame, count);
+	for ( int i = 0; i < count; i++ ) {
+		putVarint(frame, (unsigned long)keys[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: decodeView
+ *
+ * DESCRIPTION: Decodes one HYPARVIEW frame
+ *
+ * RETURNS:
+ * false if data is not a well formed HYPARVIEW frame of a known version
+ */
+bool Codec::decodeView(const char *data, int size, ViewMessage &msg, vector<long> &keys) {
+	const char *p = data + 2;
+	const char *end = data + size;
+	unsigned long ttl, flag, sender, origin, count;
+
+	if ( !isFrame(data, size) || ((unsigned char)data[0] & 0x0f) != WIRE_VERSION ) {
+		return false;
+	}
+	msg.type = (unsigned char)data[1];
+	if ( !getVarint(p, end, ttl) || !getVarint(p, end, flag) || !getVarint(p, end, sender) ||
+			!getVarint(p, end, origin) || !getVarint(p, end, count) ) {
+		return false;
+	}
+	msg.ttl = (unsigned int)ttl;
+	msg.flag = (unsigned int)flag;
+	msg.sender = sender;
+	msg.origin = origin;
+
+	if ( count > (unsigned long)(end - p) ) {
+		return false;
+	}
+	keys.resize(count);
+	for ( unsigned long i = 0; i < count; i++ ) {
+		unsigned long key;
+		if ( !getVarint(p, end, key) ) {
+			return false;
+		}
+		keys[i] = key;
+	}
+	return p == end;
+}
@@ -0,0 +1,118 @@
+/**********************************
+ * FILE NAME: Codec.h
+ *
+ * DESCRIPTION: Compact wire format of the membership messages header file
+ **********************************/
+
+#ifndef _CODEC_H_
+#define _CODEC_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/*
+ * Macros
+ */
+// first byte of a frame: the high nibble marks the compact format, the low one is its version.
+// A raw MessageHdr never starts with it, its enum value is small.
+#define WIRE_MAGIC 0xC0
+#define WIRE_VERSION 1
+// longest varint of a 64 bit value
+#define VARINT_MAX 10
+
+/**
+ * STRUCT NAME: WireEntry
+ *
+ * DESCRIPTION: One member as it travels in a frame. The receiver stamps it with its own clock.
+ */
+typedef struct WireEntry {
+	int id;
+	short port;
+	long heartbeat;
+}WireEntry;
+
+/**
+ * STRUCT NAME: SwimUpdate
+ *
+ * DESCRIPTION: Membership change piggybacked on SWIM messages. A member's incarnation
+ * 				only grows; it raises its own to refute a suspicion.
+ */
+typedef struct SwimUpdate
+{
+	int id;
+	short port;
+	short state;
+	long incarnation;
+}SwimUpdate;
+
+/**
+ * STRUCT NAME: SwimMessage
+ *
+ * DESCRIPTION: Fields of SWIM_PING, SWIM_ACK, SWIM_PINGREQ, RING_BEAT and VIEW_KEEPALIVE, which
+ * 				carry SwimUpdates besides. origin runs probe seq of target; relay is the helper
+ * 				of an indirect probe, or null.
+ */
+typedef struct SwimMessage
+{
+	int type;
+	int seq;
+	char origin[6];
+	char target[6];
+	char relay[6];
+}SwimMessage;
+
+/**
+ * STRUCT NAME: ViewMessage
+ *
+ * DESCRIPTION: Fields of the HYPARVIEW messages, which carry memberKeys besides: the sample of a
+ * 				shuffle or its reply. origin is the joiner of a FORWARDJOIN and the shuffler of a
+ * 				SHUFFLE; flag asks for a NEIGHBOR with high priority, or accepts it in the reply.
+ */
+typedef struct ViewMessage
+{
+	int type;
+	int ttl;
+	int flag;
+	long sender;
+	long origin;
+}ViewMessage;
+
+/**
+ * CLASS NAME: Codec
+ *
+ * DESCRIPTION: Encodes membership lists into frames of
+ * 				magic|version, type, sender id, sender port, entry count, base heartbeat
+ * 				followed by the entries sorted by (id, port), each as
+ * 				id minus the previous id, port, heartbeat minus the base.
+ * 				Every number is an unsigned LEB128 varint, so the bytes do not depend on
+ * 				the host's endianness or struct padding. The base is the smallest heartbeat
+ * 				of the frame. A list larger than one message is split into frames that
+ * 				each decode on their own.
+ * 				Digest frames carry fixed width words instead of entries:
+ * 				magic|version, type, sender id, sender port, word count, then every word
+ * 				as four bytes, low byte first.
+ * 				SWIM frames are magic|version, type, seq, then origin, target and relay each
+ * 				as id and port, update count, and every update as id, port, state, incarnation.
+ * 				VIEW frames are magic|version, type, ttl, flag, sender, origin, key count,
+ * 				then the keys.
+ */
+class Codec {
+public:
+	static void putVarint(vector<char> &out, unsigned long value);
+	static bool getVarint(const char *&p, const char *end, unsigned long &value);
+	static int varintSize(unsigned long value);
+	static bool isFrame(const char *data, int size);
+	static int encodeMembers(int type, Address *sender, vector<WireEntry> &entries, int maxBytes, vector< vector<char> > &frames);
+	static bool decodeMembers(const char *data, int size, int &type, Address *sender, vector<WireEntry> &entries);
+	static int frameType(const char *data);
+	static void encodeDigest(int type, Address *sender, vector<unsigned int> &words, vector<char> &frame);
+	static bool decodeDigest(const char *data, int size, int &type, Address *sender, vector<unsigned int> &words);
+	static void putAddress(vector<char> &out, const char *addr);
+	static bool getAddress(const char *&p, const char *end, char *addr);
+	static void encodeSwim(SwimMessage &msg, vector<SwimUpdate> &updates, vector<char> &frame);
+	static bool decodeSwim(const char *data, int size, SwimMessage &msg, vector<SwimUpdate> &updates);
+	static void encodeView(ViewMessage &msg, const long *keys, int count, vector<char> &frame);
+	static bool decodeView(const char *data, int size, ViewMessage &msg, vector<long> &keys);
+};
+
+#endif /* _CODEC_H_ */
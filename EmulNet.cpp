@@ -12,16 +12,16 @@
 EmulNet::EmulNet(Params *p)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
 	par = p;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
+	allocCount = 0;
+	deliverCount = 0;
+	wheelTime = -1;
+	staging = false;
+	for ( unsigned int i = 0; i < p->LINKS.size(); i++ ) {
+		links[make_pair(p->LINKS[i].from, p->LINKS[i].to)] = p->LINKS[i];
 	}
 	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
@@ -30,32 +30,42 @@ EmulNet::EmulNet(Params *p)
  * Copy constructor
  */
 EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->allocCount = anotherEmulNet.allocCount;
+	this->deliverCount = anotherEmulNet.deliverCount;
+	this->traffic = anotherEmulNet.traffic;
 	this->emulnet = anotherEmulNet.emulnet;
+	for ( int i = 0; i < WHEEL_SIZE; i++ ) {
+		this->wheel[i] = anotherEmulNet.wheel[i];
+	}
+	this->wheelTime = anotherEmulNet.wheelTime;
+	this->dueTicks = anotherEmulNet.dueTicks;
+	this->links = anotherEmulNet.links;
+	this->staging = anotherEmulNet.staging;
+	this->staged = anotherEmulNet.staged;
+	this->stagedData = anotherEmulNet.stagedData;
 }
 
 /**
  * Assignment operator overloading
  */
 EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->allocCount = anotherEmulNet.allocCount;
+	this->deliverCount = anotherEmulNet.deliverCount;
+	this->traffic = anotherEmulNet.traffic;
 	this->emulnet = anotherEmulNet.emulnet;
+	for ( int i = 0; i < WHEEL_SIZE; i++ ) {
+		this->wheel[i] = anotherEmulNet.wheel[i];
+	}
+	this->wheelTime = anotherEmulNet.wheelTime;
+	this->dueTicks = anotherEmulNet.dueTicks;
+	this->links = anotherEmulNet.links;
+	this->staging = anotherEmulNet.staging;
+	this->staged = anotherEmulNet.staged;
+	this->stagedData = anotherEmulNet.stagedData;
 	return *this;
 }
 
@@ -71,11 +81,26 @@ EmulNet::~EmulNet() {}
  */
 void *EmulNet::ENinit(Address *myaddr, short port) {
 	// Initialize data structures for this member
-	*(int *)(myaddr->addr) = emulnet.nextid++;
+	int id = emulnet.nextid++;
+	*(int *)(myaddr->addr) = id;
     *(short *)(&myaddr->addr[4]) = 0;
+
+	reserveNodes(id);
 	return myaddr;
 }
 
+/**
+ * FUNCTION NAME: dropOnSend
+ *
+ * DESCRIPTION: Decides whether a message of the given size is lost on send: the buffer
+ * 				is full, the message is too large, or it falls under the drop probability
+ */
+bool EmulNet::dropOnSend(int size) {
+	int sendmsg = rand() % 100;
+
+	return (emulnet.currbuffsize >= max(ENBUFFSIZE, par->EN_GPSZ * ENBUFFPERNODE)) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100));
+}
+
 /**
  * FUNCTION NAME: ENsend
  *
@@ -87,28 +112,37 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
 	en_msg *em;
 	static char temp[2048];
-	int sendmsg = rand() % 100;
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
+	if ( staging ) {
+		int src = addressId(myaddr);
+		assert(src >= 0 && src < (int)staged.size());
+		staged_msg msg;
+		memcpy(msg.to.addr, toaddr->addr, sizeof(msg.to.addr));
+		msg.offset = stagedData[src].size();
+		msg.size = size;
+		staged[src].push_back(msg);
+		stagedData[src].insert(stagedData[src].end(), data, data + size);
+		return size;
+	}
+
+	if( dropOnSend(size) ) {
 		return 0;
 	}
 
 	em = (en_msg *)malloc(sizeof(en_msg) + size);
 	em->size = size;
+	allocCount++;
 
 	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
 	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
 	memcpy(em + 1, data, size);
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
-
 	int src = *(int *)(myaddr->addr);
 	int time = par->getcurrtime();
 
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
+	post(em, time);
 
-	sent_msgs[src][time]++;
+	traffic.addSent(src, time, size);
 
 	#ifdef DEBUGLOG
 		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
@@ -126,17 +160,16 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
  * size
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
+	// The string's bytes are copied straight into the en_msg, no staging buffer
+	return this->ENsend(myaddr, toaddr, (char *)data.data(), (data.length() * sizeof(char)));
 }
 
 /**
  * FUNCTION NAME: ENrecv
  *
  * DESCRIPTION: EmulNet receive function
+ * 				The payload handed to enq is the en_msg's own buffer. The receiver owns it
+ * 				and must give it back with ENrelease once the message has been handled.
  *
  * RETURN:
  * 0
@@ -144,35 +177,48 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
 	int i;
-	char* tmp;
 	int sz;
 	en_msg *emsg;
+	int dst = addressId(myaddr);
+	unsigned int kept = 0;
 
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
+	// A phase has moved the wheel forward before it started
+	if ( !staging ) {
+		advanceWheel(par->getcurrtime());
+	}
 
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+	if ( dst < 0 || dst >= (int)emulnet.mailbox.size() ) {
+		return 0;
+	}
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+	vector<en_msg *> &box = emulnet.mailbox[dst];
 
-			(*enq)(queue, (char *)tmp, sz);
+	// Hand out the newest message first, the order a scan from the tail of a single shared buffer gives
+	for( i = box.size() - 1; i >= 0; i-- ) {
+		emsg = box[i];
 
-			free(emsg);
+		if ( 0 == memcmp(emsg->to.addr, myaddr->addr, sizeof(myaddr->addr)) ) {
+			sz = emsg->size;
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+			box[i] = NULL;
+			// Nodes of a phase receive in parallel
+			__atomic_sub_fetch(&emulnet.currbuffsize, 1, __ATOMIC_RELAXED);
+			__atomic_add_fetch(&deliverCount, 1, __ATOMIC_RELAXED);
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+			(*enq)(queue, (char *)(emsg+1), sz);
 
-			recv_msgs[dst][time]++;
+			traffic.addRecv(dst, par->getcurrtime(), sz);
 		}
 	}
 
+	// Keep whatever was sent to another port of the same id, in its original order
+	for( i = 0; i < (int)box.size(); i++ ) {
+		if ( box[i] != NULL ) {
+			box[kept++] = box[i];
+		}
+	}
+	box.resize(kept);
+
 	return 0;
 }
 
@@ -185,36 +231,376 @@ int EmulNet::ENcleanup() {
 	emulnet.nextid=0;
 	int i, j;
 	int sent_total, recv_total;
+	long sent_bytes, recv_bytes;
+	vector<int> sent_msgs, recv_msgs;
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.mailbox.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.mailbox[i].size(); j++ ) {
+			free(emulnet.mailbox[i][j]);
+		}
+		emulnet.mailbox[i].clear();
+	}
+	for ( i = 0; i < WHEEL_SIZE; i++ ) {
+		for ( j = 0; j < (int)wheel[i].size(); j++ ) {
+			free(wheel[i][j].msg);
+		}
+		wheel[i].clear();
 	}
+	dueTicks = priority_queue< int, vector<int>, greater<int> >();
+	emulnet.currbuffsize = 0;
 
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
 		fprintf(file, "node %3d ", i);
 		sent_total = 0;
 		recv_total = 0;
+		traffic.getRange(i, par->getcurrtime(), sent_msgs, recv_msgs);
 
 		for (j = 0; j < par->getcurrtime(); j++) {
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
+			sent_total += sent_msgs[j];
+			recv_total += recv_msgs[j];
 			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, " (%4d, %4d)", sent_msgs[j], recv_msgs[j]);
 				if (j % 10 == 9) {
 					fprintf(file, "\n         ");
 				}
 			}
 			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[j], recv_msgs[j]);
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		traffic.getBytes(i, sent_bytes, recv_bytes);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u  sent_bytes %9ld  recv_bytes %9ld\n\n", i, sent_total, recv_total, sent_bytes, recv_bytes);
 	}
 
+	fprintf(file, "allocations %ld  delivered %ld  allocations/delivered %.2f\n", allocCount, deliverCount, deliverCount ? (double)allocCount / deliverCount : 0.0);
+
 	fclose(file);
 	return 0;
 }
+
+/**
+ * FUNCTION NAME: reserveNodes
+ *
+ * DESCRIPTION: Sizes the per node state for ids up to maxId up front,
+ * 				so that nodes running in parallel never resize it
+ */
+void EmulNet::reserveNodes(int maxId) {
+	if ( maxId >= (int)emulnet.mailbox.size() ) {
+		emulnet.mailbox.resize(maxId + 1);
+	}
+	if ( maxId >= (int)staged.size() ) {
+		staged.resize(maxId + 1);
+		stagedData.resize(maxId + 1);
+	}
+	traffic.reserve(maxId);
+}
+
+/**
+ * FUNCTION NAME: ENbeginPhase
+ *
+ * DESCRIPTION: Starts a phase in which several nodes may send and receive in parallel.
+ * 				The wheel is brought up to date here, and sends are held per source
+ * 				until ENcommit, so that nothing a node sends in the phase reaches a
+ * 				mailbox another thread is reading.
+ */
+void EmulNet::ENbeginPhase() {
+	// A network nodes never ENinit on is sized here, for ids 1..EN_GPSZ
+	reserveNodes(par->EN_GPSZ);
+	advanceWheel(par->getcurrtime());
+	staging = true;
+}
+
+/**
+ * FUNCTION NAME: ENendPhase
+ *
+ * DESCRIPTION: Ends the phase; sends go out directly again
+ */
+void EmulNet::ENendPhase() {
+	staging = false;
+}
+
+/**
+ * FUNCTION NAME: ENcommit
+ *
+ * DESCRIPTION: Sends what myaddr's node staged during the phase, in the order it sent it.
+ * 				Committing the nodes in the order a serial loop runs them repeats that loop's
+ * 				drops and delays exactly.
+ */
+void EmulNet::ENcommit(Address *myaddr) {
+	int src = addressId(myaddr);
+	if ( src < 0 || src >= (int)staged.size() ) {
+		return;
+	}
+
+	vector<staged_msg> &msgs = staged[src];
+	vector<char> &data = stagedData[src];
+	for ( unsigned int i = 0; i < msgs.size(); i++ ) {
+		this->ENsend(myaddr, &msgs[i].to, &data[msgs[i].offset], msgs[i].size);
+	}
+	msgs.clear();
+	data.clear();
+}
+
+/**
+ * FUNCTION NAME: ENhasMail
+ *
+ * DESCRIPTION: Whether a message is waiting for myaddr's node at the current tick
+ */
+bool EmulNet::ENhasMail(Address *myaddr) {
+	int dst = addressId(myaddr);
+
+	advanceWheel(par->getcurrtime());
+	return dst >= 0 && dst < (int)emulnet.mailbox.size() && !emulnet.mailbox[dst].empty();
+}
+
+/**
+ * FUNCTION NAME: ENnextDelivery
+ *
+ * DESCRIPTION: Earliest tick at which a message still on the wheel reaches a mailbox
+ *
+ * RETURNS:
+ * the tick, or INT_MAX if the wheel is empty
+ */
+int EmulNet::ENnextDelivery() {
+	if ( dueTicks.empty() ) {
+		return INT_MAX;
+	}
+	return dueTicks.top();
+}
+
+/**
+ * FUNCTION NAME: linkDelay
+ *
+ * DESCRIPTION: Draws the number of ticks a message from src to dst spends on the link on top
+ * 				of the one tick hop every message takes. A delay of 0 delivers on the next
+ * 				ENrecv, like a link without latency; a delay of d delivers d ticks later.
+ */
+int EmulNet::linkDelay(int src, int dst) {
+	int latency = par->LATENCY;
+	int jitter = par->JITTER;
+	int delay;
+
+	if ( !links.empty() ) {
+		map< pair<int, int>, LinkDelay >::iterator search = links.find(make_pair(src, dst));
+		if ( search != links.end() ) {
+			latency = search->second.latency;
+			jitter = search->second.jitter;
+		}
+	}
+
+	delay = latency;
+	if ( jitter > 0 ) {
+		if ( par->JITTER_DIST == EXPONENTIAL_JITTER ) {
+			// mean jitter, with a long tail
+			delay += (int)(-jitter * log(1.0 - rand() / (RAND_MAX + 1.0)));
+		}
+		else {
+			delay += rand() % (jitter + 1);
+		}
+	}
+
+	return delay;
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Puts a message sent at the given tick in flight. Without delay it would be
+ * 				received on the next tick, so it is due delay ticks after that. It goes
+ * 				straight to the mailbox if the link has no delay or its delivery tick has
+ * 				already been passed, and onto the wheel otherwise.
+ */
+void EmulNet::post(en_msg *em, int time) {
+	int delay = linkDelay(addressId(&em->from), addressId(&em->to));
+	int due = time + 1 + delay;
+
+	emulnet.currbuffsize++;
+	if ( delay <= 0 || due <= wheelTime ) {
+		deliver(em);
+	}
+	else {
+		// Park the message on the wheel until its delivery tick
+		wheel_elt elt;
+		elt.due = due;
+		elt.msg = em;
+		wheel[elt.due & (WHEEL_SIZE - 1)].push_back(elt);
+		dueTicks.push(due);
+	}
+}
+
+/**
+ * FUNCTION NAME: deliver
+ *
+ * DESCRIPTION: Puts a message into the mailbox of its destination
+ */
+void EmulNet::deliver(en_msg *em) {
+	int dst = addressId(&em->to);
+	assert(dst >= 0);
+	if ( dst >= (int)emulnet.mailbox.size() ) {
+		emulnet.mailbox.resize(dst + 1);
+	}
+	emulnet.mailbox[dst].push_back(em);
+}
+
+/**
+ * FUNCTION NAME: advanceWheel
+ *
+ * DESCRIPTION: Moves every message due by the given tick from the wheel into the mailboxes.
+ * 				Each tick's slot is visited once, and a message only stays in its slot
+ * 				while it is a whole wheel turn or more away, so delivery is O(1) per message.
+ */
+void EmulNet::advanceWheel(int time) {
+	int first = wheelTime + 1;
+	int t;
+
+	if ( time <= wheelTime ) {
+		return;
+	}
+	// After a long idle stretch, one pass over all the slots is enough
+	if ( time - first >= WHEEL_SIZE ) {
+		first = time - WHEEL_SIZE + 1;
+	}
+
+	for ( t = first; t <= time; t++ ) {
+		vector<wheel_elt> &slot = wheel[t & (WHEEL_SIZE - 1)];
+		unsigned int kept = 0;
+		for ( unsigned int k = 0; k < slot.size(); k++ ) {
+			if ( slot[k].due <= time ) {
+				deliver(slot[k].msg);
+			}
+			else {
+				slot[kept++] = slot[k];
+			}
+		}
+		slot.resize(kept);
+	}
+	while ( !dueTicks.empty() && dueTicks.top() <= time ) {
+		dueTicks.pop();
+	}
+	wheelTime = time;
+}
+
+/**
+ * FUNCTION NAME: addressId
+ *
+ * DESCRIPTION: Returns the node id stored in the first four bytes of an address.
+ * 				This is the index of the node's mailbox.
+ */
+int EmulNet::addressId(Address *addr) {
+	int id;
+	memcpy(&id, &addr->addr[0], sizeof(int));
+	return id;
+}
+
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: Frees a payload handed out by ENrecv, together with the en_msg in front of it
+ */
+void EmulNet::ENrelease(char *data) {
+	if ( data != NULL ) {
+		free((en_msg *)data - 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: current
+ *
+ * DESCRIPTION: Returns the record of node id for tick time, appending a zeroed one if needed
+ */
+tick_count *TrafficCounter::current(int id, int time) {
+	assert(id >= 0);
+	if ( id >= (int)counts.size() ) {
+		counts.resize(id + 1);
+	}
+
+	vector<tick_count> &records = counts[id];
+	if ( records.empty() || records.back().time != time ) {
+		assert(records.empty() || records.back().time < time);
+		tick_count record;
+		record.time = time;
+		record.sent = 0;
+		record.recv = 0;
+		record.sentBytes = 0;
+		record.recvBytes = 0;
+		records.push_back(record);
+	}
+	return &records.back();
+}
+
+/**
+ * FUNCTION NAME: reserve
+ *
+ * DESCRIPTION: Makes room for node id, so that updates for it never resize the store
+ */
+void TrafficCounter::reserve(int id) {
+	assert(id >= 0);
+	if ( id >= (int)counts.size() ) {
+		counts.resize(id + 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: addSent
+ *
+ * DESCRIPTION: Count one message of size bytes sent by node id at tick time
+ */
+void TrafficCounter::addSent(int id, int time, int size) {
+	tick_count *record = current(id, time);
+	record->sent++;
+	record->sentBytes += size;
+}
+
+/**
+ * FUNCTION NAME: addRecv
+ *
+ * DESCRIPTION: Count one message of size bytes received by node id at tick time
+ */
+void TrafficCounter::addRecv(int id, int time, int size) {
+	tick_count *record = current(id, time);
+	record->recv++;
+	record->recvBytes += size;
+}
+
+/**
+ * FUNCTION NAME: getRange
+ *
+ * DESCRIPTION: Expands the records of node id into dense per tick counts for ticks [0, endTime)
+ */
+void TrafficCounter::getRange(int id, int endTime, vector<int> &sent, vector<int> &recv) {
+	sent.assign(endTime, 0);
+	recv.assign(endTime, 0);
+	if ( id < 0 || id >= (int)counts.size() ) {
+		return;
+	}
+
+	for ( unsigned int k = 0; k < counts[id].size(); k++ ) {
+		tick_count &record = counts[id][k];
+		if ( record.time >= 0 && record.time < endTime ) {
+			sent[record.time] = record.sent;
+			recv[record.time] = record.recv;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: getBytes
+ *
+ * DESCRIPTION: Total bytes node id sent and received
+ */
+void TrafficCounter::getBytes(int id, long &sent, long &recv) {
+	sent = 0;
+	recv = 0;
+	if ( id < 0 || id >= (int)counts.size() ) {
+		return;
+	}
+
+	for ( unsigned int k = 0; k < counts[id].size(); k++ ) {
+		sent += counts[id][k].sentBytes;
+		recv += counts[id][k].recvBytes;
+	}
+}
@@ -7,13 +7,16 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
 #define ENBUFFSIZE 30000
+// messages in flight allowed per node of large groups, where ENBUFFSIZE alone would throttle the whole network
+#define ENBUFFPERNODE 100
+// slots of the delivery wheel, a power of two larger than the usual link latency
+#define WHEEL_SIZE 256
 
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include <climits>
 
 using namespace std;
 
@@ -29,25 +32,47 @@ typedef struct en_msg {
 	Address to;
 }en_msg;
 
+/**
+ * Struct Name: wheel_elt
+ */
+typedef struct wheel_elt {
+	// tick at which the message reaches the destination's mailbox
+	int due;
+	en_msg *msg;
+}wheel_elt;
+
+/**
+ * Struct Name: staged_msg
+ */
+typedef struct staged_msg {
+	// Destination node
+	Address to;
+	// Where the payload starts in the sender's staging buffer
+	int offset;
+	int size;
+}staged_msg;
+
 /**
  * Class Name: EM
+ *
+ * DESCRIPTION: Messages in flight, kept in one mailbox per destination node.
+ * 				currbuffsize counts the messages in the mailboxes and on the
+ * 				delivery wheel and is bounded by ENBUFFSIZE, or ENBUFFPERNODE per node
+ * 				in groups large enough for that to be more.
  */
 class EM {
 public:
 	int nextid;
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	// mailbox[id] holds the messages addressed to the node with that id, oldest first
+	vector< vector<en_msg *> > mailbox;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->mailbox = anotherEM.mailbox;
 		return *this;
 	}
 	int getNextId() {
@@ -71,6 +96,38 @@ public:
 	virtual ~EM() {}
 };
 
+/**
+ * Struct Name: tick_count
+ */
+typedef struct tick_count {
+	int time;
+	int sent;
+	int recv;
+	int sentBytes;
+	int recvBytes;
+}tick_count;
+
+/**
+ * CLASS NAME: TrafficCounter
+ *
+ * DESCRIPTION: Per node, per tick message and byte counts. Each node keeps one record
+ * 				per tick in which it actually sent or received something, so the
+ * 				store grows with the nodes and ticks in use. Time never goes back,
+ * 				which lets every update append to or bump the node's last record.
+ */
+class TrafficCounter {
+private:
+	// counts[id] holds the records of the node with that id, in time order
+	vector< vector<tick_count> > counts;
+	tick_count *current(int id, int time);
+public:
+	void addSent(int id, int time, int size);
+	void addRecv(int id, int time, int size);
+	void reserve(int id);
+	void getRange(int id, int endTime, vector<int> &sent, vector<int> &recv);
+	void getBytes(int id, long &sent, long &recv);
+};
+
 /**
  * CLASS NAME: EmulNet
  *
@@ -78,22 +135,50 @@ public:
  */
 class EmulNet
 { 	
-private:
+protected:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	TrafficCounter traffic;
 	int enInited;
+	// en_msg allocations and deliveries, reported by ENcleanup
+	long allocCount;
+	long deliverCount;
 	EM emulnet;
+	bool dropOnSend(int size);
+	void post(en_msg *em, int time);
+private:
+	// hashed timing wheel of delayed messages, slot = due tick % WHEEL_SIZE
+	vector<wheel_elt> wheel[WHEEL_SIZE];
+	// last tick whose slot has been emptied into the mailboxes
+	int wheelTime;
+	// due tick of every message on the wheel, earliest first
+	priority_queue< int, vector<int>, greater<int> > dueTicks;
+	// per link overrides of the default latency, keyed by (from id, to id)
+	map< pair<int, int>, LinkDelay > links;
+	// while a phase runs, sends are held per source id until ENcommit
+	bool staging;
+	vector< vector<staged_msg> > staged;
+	vector< vector<char> > stagedData;
+	int linkDelay(int src, int dst);
+	void reserveNodes(int maxId);
+	void deliver(en_msg *em);
+	void advanceWheel(int time);
 public:
  	EmulNet(Params *p);
  	EmulNet(EmulNet &anotherEmulNet);
  	EmulNet& operator = (EmulNet &anotherEmulNet);
  	virtual ~EmulNet();
-	void *ENinit(Address *myaddr, short port);
+	virtual void *ENinit(Address *myaddr, short port);
 	int ENsend(Address *myaddr, Address *toaddr, string data);
-	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
-	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
-	int ENcleanup();
+	virtual int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	virtual int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	virtual int ENcleanup();
+	void ENbeginPhase();
+	void ENendPhase();
+	void ENcommit(Address *myaddr);
+	bool ENhasMail(Address *myaddr);
+	int ENnextDelivery();
+	static void ENrelease(char *data);
+	static int addressId(Address *addr);
 };
 
 #endif /* _EMULNET_H_ */
@@ -1,25 +1,30 @@
 /**********************************
- * FILE NAME: Application.h
+ * FILE NAME: Entry.h
  *
  * DESCRIPTION: Header file Entry class
  **********************************/
 
+#ifndef ENTRY_H_
+#define ENTRY_H_
+
 #include "stdincludes.h"
 #include "Message.h"
 
 /**
  * CLASS NAME: Entry
  *
- * DESCRIPTION: This class describes the entry for each key in the DHT
+ * DESCRIPTION: This class describes the entry for each key in the DHT. The hash table holds
+ * 				it as is, so reading a field never parses anything and the value may hold any
+ * 				bytes, ':' included.
  */
 class Entry{
 public:
 	string value;
 	int timestamp;
 	ReplicaType replica;
-	string delimiter;
 
-	Entry(string entry);
-	Entry(string _value, int _timestamp, ReplicaType _replica);
-	string convertToString();
+	Entry();
+	Entry(const string &_value, int _timestamp, ReplicaType _replica);
 };
+
+#endif /* ENTRY_H_ */
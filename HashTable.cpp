@@ -6,10 +6,145 @@
 
 #include "HashTable.h"
 
-HashTable::HashTable() {}
+HashTable::HashTable() {
+	size = 0;
+	for ( int r = 0; r < HASHTABLE_REPLICAS; r++ ) {
+		replicaHeads[r] = -1;
+	}
+}
 
 HashTable::~HashTable() {}
 
+/**
+ * FUNCTION NAME: hashOf
+ *
+ * DESCRIPTION: Hash of a key, the low bits of which pick its slot
+ */
+unsigned int HashTable::hashOf(const string &key) {
+	return (unsigned int)std::hash<string>()(key);
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Looks for key, whose hash is hash. Only keys with the same hash are compared.
+ *
+ * RETURNS:
+ * slot of the key if found
+ * -1 otherwise
+ */
+long HashTable::find(const string &key, unsigned int hash) {
+	if ( meta.empty() ) {
+		return -1;
+	}
+	unsigned long mask = meta.size() - 1;
+	unsigned long i = hash & mask;
+	for ( unsigned int distance = 1; ; distance++ ) {
+		// an empty slot, or a key closer to its own slot than key would be here
+		if ( meta[i].distance < distance ) {
+			return -1;
+		}
+		if ( meta[i].hash == hash && slots[i].key == key ) {
+			return i;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+/**
+ * FUNCTION NAME: insert
+ *
+ * DESCRIPTION: Puts a key that is not in the table into it, taking the slot of every key
+ * 				on the way that is closer to its own slot and carrying that key on instead.
+ * 				The key and entry are swapped in, so key and value are left with whatever they
+ * 				were swapped with. Every slot written is linked again into its replica list.
+ * 				There must be an empty slot.
+ */
+void HashTable::insert(unsigned int hash, string &key, Entry &value) {
+	unsigned long mask = meta.size() - 1;
+	unsigned long i = hash & mask;
+	unsigned int distance = 1;
+
+	while ( meta[i].distance ) {
+		if ( meta[i].distance < distance ) {
+			unlink(i);
+			swap(meta[i].distance, distance);
+			swap(meta[i].hash, hash);
+			slots[i].key.swap(key);
+			swap(slots[i].value, value);
+			link(i);
+		}
+		i = (i + 1) & mask;
+		distance++;
+	}
+	meta[i].distance = distance;
+	meta[i].hash = hash;
+	slots[i].key.swap(key);
+	swap(slots[i].value, value);
+	link(i);
+	size++;
+}
+
+/**
+ * FUNCTION NAME: grow
+ *
+ * DESCRIPTION: Doubles the slots, or makes the first ones, and moves every key over using its
+ * 				stored hash
+ */
+void HashTable::grow() {
+	unsigned long capacity = meta.empty() ? HASHTABLE_MIN_SLOTS : 2 * meta.size();
+	vector<HashMeta> oldMeta(capacity);
+	vector<HashSlot> oldSlots(capacity);
+
+	oldMeta.swap(meta);
+	oldSlots.swap(slots);
+	size = 0;
+	for ( int r = 0; r < HASHTABLE_REPLICAS; r++ ) {
+		replicaHeads[r] = -1;
+	}
+	for ( unsigned long i = 0; i < oldMeta.size(); i++ ) {
+		if ( oldMeta[i].distance ) {
+			insert(oldMeta[i].hash, oldSlots[i].key, oldSlots[i].value);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: link
+ *
+ * DESCRIPTION: Puts an occupied slot at the head of the list of the replica type its entry holds
+ */
+void HashTable::link(long index) {
+	HashSlot &slot = slots[index];
+	long &head = replicaHeads[slot.value.replica];
+
+	slot.prev = -1;
+	slot.next = head;
+	if ( slot.next >= 0 ) {
+		slots[slot.next].prev = index;
+	}
+	head = index;
+}
+
+/**
+ * FUNCTION NAME: unlink
+ *
+ * DESCRIPTION: Takes an occupied slot out of the list of its replica type
+ */
+void HashTable::unlink(long index) {
+	HashSlot &slot = slots[index];
+
+	if ( slot.prev >= 0 ) {
+		slots[slot.prev].next = slot.next;
+	}
+	else {
+		replicaHeads[slot.value.replica] = slot.next;
+	}
+	if ( slot.next >= 0 ) {
+		slots[slot.next].prev = slot.prev;
+	}
+}
+
 /**
  * FUNCTION NAME: create
  *
@@ -19,8 +154,19 @@ HashTable::~HashTable() {}
  * true on SUCCESS
  * false in FAILURE
  */
-bool HashTable::create(string key, string value) {
-	hashTable.emplace(key, value);
+bool HashTable::create(const string &key, const Entry &value) {
+	unsigned int hash = hashOf(key);
+
+	if ( find(key, hash) >= 0 ) {
+		// Key already there, it keeps its value
+		return true;
+	}
+	if ( (size + 1) * HASHTABLE_LOAD_DEN > meta.size() * HASHTABLE_LOAD_NUM ) {
+		grow();
+	}
+	string newKey = key;
+	Entry newValue = value;
+	insert(hash, newKey, newValue);
 	return true;
 }
 
@@ -30,20 +176,19 @@ bool HashTable::create(string key, string value) {
  * DESCRIPTION: This function searches for the key in the hash table
  *
  * RETURNS:
- * string value if found
+ * the entry, in its slot, if found
  * else it returns a NULL
  */
-string HashTable::read(string key) {
-	map<string, string>::iterator search;
+const Entry *HashTable::read(const string &key) {
+	long search = find(key, hashOf(key));
 
-	search = hashTable.find(key);
-	if ( search != hashTable.end() ) {
+	if ( search >= 0 ) {
 		// Value found
-		return search->second;
+		return &slots[search].value;
 	}
 	else {
 		// Value not found
-		return "";
+		return NULL;
 	}
 }
 
@@ -51,22 +196,23 @@ string HashTable::read(string key) {
  * FUNCTION NAME: update
  *
  * DESCRIPTION: This function updates the given key with the updated value passed in
- * 				if the key is found
+ * 				if the key is found. The value is overwritten in its slot.
  *
  * RETURNS:
  * true on SUCCESS
  * false on FAILURE
  */
-bool HashTable::update(string key, string newValue) {
-	map<string, string>::iterator update;
+bool HashTable::update(const string &key, const Entry &newValue) {
+	long update = find(key, hashOf(key));
 
-	if (read(key).empty()) {
+	if ( update < 0 ) {
 		// Key not found
 		return false;
 	}
 	// Key found
-	//update = hashTable.at(key) = newValue;
-	hashTable.at(key) = newValue;
+	unlink(update);
+	slots[update].value = newValue;
+	link(update);
 	// Update successful
 	return true;
 }
@@ -74,28 +220,81 @@ bool HashTable::update(string key, string newValue) {
 /**
  * FUNCTION NAME: deleteKey
  *
- * DESCRIPTION: This function deletes the given key and the corresponding value if the key is found
+ * DESCRIPTION: This function deletes the given key and the corresponding value if the key is found.
+ * 				The keys after it that are away from their own slot move back by one.
  *
  * RETURNS:
  * true on SUCCESS
  * false on FAILURE
  */
-bool HashTable::deleteKey(string key) {
-	uint eraseCount = 0;
+bool HashTable::deleteKey(const string &key) {
+	long erase = find(key, hashOf(key));
 
-	if (read(key).empty()) {
+	if ( erase < 0 ) {
 		// Key not found
 		return false;
 	}
-	eraseCount = hashTable.erase(key);
-	if ( eraseCount < 1 ) {
-		// Could not erase
-		return false;
+	unsigned long mask = meta.size() - 1;
+	unsigned long i = erase;
+	unsigned long next = (i + 1) & mask;
+	unlink(i);
+	while ( meta[next].distance > 1 ) {
+		unlink(next);
+		meta[i].distance = meta[next].distance - 1;
+		meta[i].hash = meta[next].hash;
+		slots[i].key.swap(slots[next].key);
+		swap(slots[i].value, slots[next].value);
+		link(i);
+		i = next;
+		next = (next + 1) & mask;
 	}
+	meta[i].distance = 0;
+	slots[i] = HashSlot();
+	size--;
 	// Delete was successful
 	return true;
 }
 
+/**
+ * FUNCTION NAME: setReplica
+ *
+ * DESCRIPTION: Changes the replica type the given key is held as, if the key is found
+ *
+ * RETURNS:
+ * true on SUCCESS
+ * false on FAILURE
+ */
+bool HashTable::setReplica(const string &key, ReplicaType replica) {
+	long search = find(key, hashOf(key));
+
+	if ( search < 0 ) {
+		// Key not found
+		return false;
+	}
+	unlink(search);
+	slots[search].value.replica = replica;
+	link(search);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: moveReplicas
+ *
+ * DESCRIPTION: Makes every key held as replica type from held as to instead, in time
+ * 				proportional to their number
+ */
+void HashTable::moveReplicas(ReplicaType from, ReplicaType to) {
+	if ( from == to ) {
+		return;
+	}
+	while ( replicaHeads[from] >= 0 ) {
+		long index = replicaHeads[from];
+		unlink(index);
+		slots[index].value.replica = to;
+		link(index);
+	}
+}
+
 /**
  * FUNCTION NAME: isEmpty
  *
@@ -106,7 +305,7 @@ bool HashTable::deleteKey(string key) {
  * false otherwise
  */
 bool HashTable::isEmpty() {
-	return hashTable.empty();
+	return size == 0;
 }
 
 /**
@@ -118,7 +317,7 @@ bool HashTable::isEmpty() {
  * size of the table as unit
  */
 unsigned long HashTable::currentSize() {
-	return (unsigned  long)hashTable.size();
+	return size;
 }
 
 /**
@@ -127,7 +326,12 @@ unsigned long HashTable::currentSize() {
  * DESCRIPTION: Clear all contents from the hash table
  */
 void HashTable::clear() {
-	hashTable.clear();
+	vector<HashMeta>().swap(meta);
+	vector<HashSlot>().swap(slots);
+	size = 0;
+	for ( int r = 0; r < HASHTABLE_REPLICAS; r++ ) {
+		replicaHeads[r] = -1;
+	}
 }
 
 /**
@@ -138,7 +342,7 @@ void HashTable::clear() {
  * RETURNS:
  * unsigned long count (Should be always 1)
  */
-unsigned long HashTable::count(string key) {
-	return (unsigned long) hashTable.count(key);
+unsigned long HashTable::count(const string &key) {
+	return find(key, hashOf(key)) >= 0 ? 1 : 0;
 }
 
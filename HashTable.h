@@ -14,26 +14,108 @@
 #include "common.h"
 #include "Entry.h"
 
+/*
+ * Macros
+ */
+// slots of the table once it holds a key, a power of two
+#define HASHTABLE_MIN_SLOTS 16
+// the table doubles before more than HASHTABLE_LOAD_NUM / HASHTABLE_LOAD_DEN of its slots are taken
+#define HASHTABLE_LOAD_NUM 7
+#define HASHTABLE_LOAD_DEN 8
+// replica types an entry can hold
+#define HASHTABLE_REPLICAS (TERTIARY + 1)
+
 /**
- * CLASS NAME: HashTable
+ * STRUCT NAME: HashMeta
  *
- * DESCRIPTION: This class is a wrapper to the map provided by C++ STL.
+ * DESCRIPTION: What a probe looks at of one slot, kept apart from the strings so that a probe
+ * 				walks a dense array and only touches a key whose hash matches
+ */
+typedef struct HashMeta {
+	// distance from the slot the hash points at, plus one; 0 for an empty slot
+	unsigned int distance;
+	unsigned int hash;
+}HashMeta;
+
+/**
+ * STRUCT NAME: HashSlot
  *
+ * DESCRIPTION: Key and entry of one slot, linked by slot into the list of the keys held as
+ * 				the same replica type
+ */
+typedef struct HashSlot {
+	string key;
+	Entry value;
+	long prev;
+	long next;
+}HashSlot;
+
+/**
+ * CLASS NAME: HashTable
+ *
+ * DESCRIPTION: Open addressing hash table with Robin Hood probing. A key lives at the slot
+ * 				its hash points at or linearly after it; on insert a key further from its own
+ * 				slot takes the place of one closer to its own, so probe lengths stay short and
+ * 				even, and a lookup stops as soon as it passes a key closer to home than it
+ * 				would be. Deletes shift the keys after the hole back by one, leaving no
+ * 				tombstones. The hash of every key is stored, so growing never hashes again.
+ * 				The keys held as each replica type form a doubly linked list through their
+ * 				slots, relinked whenever a key moves or changes type, so the keys of one type
+ * 				are walked without looking at the others.
  */
 class HashTable {
+private:
+	vector<HashMeta> meta;
+	vector<HashSlot> slots;
+	unsigned long size;
+	// first slot of the list of each replica type
+	long replicaHeads[HASHTABLE_REPLICAS];
+	static unsigned int hashOf(const string &key);
+	long find(const string &key, unsigned int hash);
+	void insert(unsigned int hash, string &key, Entry &value);
+	void grow();
+	void link(long index);
+	void unlink(long index);
 public:
-	map<string, string> hashTable;
-//public:
 	HashTable();
-	bool create(string key, string value);
-	string read(string key);
-	bool update(string key, string newValue);
-	bool deleteKey(string key);
+	bool create(const string &key, const Entry &value);
+	const Entry *read(const string &key);
+	bool update(const string &key, const Entry &newValue);
+	bool deleteKey(const string &key);
+	bool setReplica(const string &key, ReplicaType replica);
+	void moveReplicas(ReplicaType from, ReplicaType to);
 	bool isEmpty();
 	unsigned long currentSize();
 	void clear();
-	unsigned long count(string key);
+	unsigned long count(const string &key);
+	template<typename Visitor> void forEach(Visitor visit);
+	template<typename Visitor> void forEachOf(ReplicaType replica, Visitor visit);
 	virtual ~HashTable();
 };
 
+/**
+ * FUNCTION NAME: forEach
+ *
+ * DESCRIPTION: Calls visit(key, entry) for every key, in slot order
+ */
+template<typename Visitor> void HashTable::forEach(Visitor visit) {
+	for ( unsigned long i = 0; i < meta.size(); i++ ) {
+		if ( meta[i].distance ) {
+			visit((const string &)slots[i].key, (const Entry &)slots[i].value);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: forEachOf
+ *
+ * DESCRIPTION: Calls visit(key, entry) for every key held as replica, in time proportional to
+ * 				their number. visit must not change the table.
+ */
+template<typename Visitor> void HashTable::forEachOf(ReplicaType replica, Visitor visit) {
+	for ( long i = replicaHeads[replica]; i >= 0; i = slots[i].next ) {
+		visit((const string &)slots[i].key, (const Entry &)slots[i].value);
+	}
+}
+
 #endif /* HASHTABLE_H_ */
@@ -6,6 +6,9 @@
 
 #include "Log.h"
 
+mutex Log::writeLock;
+thread_local vector<LogRecord> *Log::capture = NULL;
+
 /**
  * Constructor
  */
@@ -40,18 +43,43 @@ Log::~Log() {}
  * FUNCTION NAME: LOG
  *
  * DESCRIPTION: Print out to file dbg.log, along with Address of node.
+ * 				While this thread captures its output the line is kept for flush instead.
  */
 void Log::LOG(Address *addr, const char * str, ...) {
 
+	va_list vararglist;
+	char buffer[30000];
+
+	va_start(vararglist, str);
+	vsprintf(buffer, str, vararglist);
+	va_end(vararglist);
+
+	if ( capture != NULL ) {
+		LogRecord record;
+		record.addr = *addr;
+		record.text = buffer;
+		capture->push_back(record);
+		return;
+	}
+
+	write(addr, buffer);
+}
+
+/**
+ * FUNCTION NAME: write
+ *
+ * DESCRIPTION: Writes one formatted line to dbg.log, or to stats.log for #STATSLOG# lines
+ */
+void Log::write(Address *addr, const char *buffer) {
+
 	static FILE *fp;
 	static FILE *fp2;
-	va_list vararglist;
-	static char buffer[30000];
 	static int numwrites;
 	static char stdstring[30];
 	static char stdstring2[40];
 	static char stdstring3[40]; 
 	static int dbg_opened=0;
+	lock_guard<mutex> guard(writeLock);
 
 	if(dbg_opened != 639){
 		numwrites=0;
@@ -72,10 +100,6 @@ void Log::LOG(Address *addr, const char * str, ...) {
 
 	sprintf(stdstring, "%d.%d.%d.%d:%d ", addr->addr[0], addr->addr[1], addr->addr[2], addr->addr[3], *(short *)&addr->addr[4]);
 
-	va_start(vararglist, str);
-	vsprintf(buffer, str, vararglist);
-	va_end(vararglist);
-
 	if (!firstTime) {
 		int magicNumber = 0;
 		string magic = MAGIC_NUMBER;
@@ -108,13 +132,43 @@ void Log::LOG(Address *addr, const char * str, ...) {
 
 }
 
+/**
+ * FUNCTION NAME: beginCapture
+ *
+ * DESCRIPTION: Keeps the calling thread's log lines in records until endCapture
+ */
+void Log::beginCapture(vector<LogRecord> *records) {
+	capture = records;
+}
+
+/**
+ * FUNCTION NAME: endCapture
+ *
+ * DESCRIPTION: The calling thread writes its log lines to the files again
+ */
+void Log::endCapture() {
+	capture = NULL;
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Writes out captured lines, in the order they were logged, and empties records
+ */
+void Log::flush(vector<LogRecord> &records) {
+	for ( unsigned int i = 0; i < records.size(); i++ ) {
+		write(&records[i].addr, records[i].text.c_str());
+	}
+	records.clear();
+}
+
 /**
  * FUNCTION NAME: logNodeAdd
  *
  * DESCRIPTION: To Log a node add
  */
 void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
-	static char stdstring[30];
+	char stdstring[100];
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", addedAddr->addr[0], addedAddr->addr[1], addedAddr->addr[2], addedAddr->addr[3], *(short *)&addedAddr->addr[4], par->getcurrtime());
     LOG(thisNode, stdstring);
 }
@@ -125,7 +179,7 @@ void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
  * DESCRIPTION: To log a node remove
  */
 void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
-	static char stdstring[30];
+	char stdstring[100];
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", removedAddr->addr[0], removedAddr->addr[1], removedAddr->addr[2], removedAddr->addr[3], *(short *)&removedAddr->addr[4], par->getcurrtime());
     LOG(thisNode, stdstring);
 }
@@ -136,7 +190,7 @@ void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
  * DESCRTION: Call this function after successfully create a key value pair
  */
 void Log::logCreateSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
+	char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -152,7 +206,7 @@ void Log::logCreateSuccess(Address * address, bool isCoordinator, int transID, s
  * DESCRIPTION: Call this function after successfully reading a key
  */
 void Log::logReadSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -168,7 +222,7 @@ void Log::logReadSuccess(Address * address, bool isCoordinator, int transID, str
  * DESCRIPTION: Call this function after successfully updating a key
  */
 void Log::logUpdateSuccess(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -184,7 +238,7 @@ void Log::logUpdateSuccess(Address * address, bool isCoordinator, int transID, s
  * DESCRIPTION: Call this function after successfully deleting a key
  */
 void Log::logDeleteSuccess(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -200,7 +254,7 @@ void Log::logDeleteSuccess(Address * address, bool isCoordinator, int transID, s
  * DESCRIPTION: Call this function if CREATE failed
  */
 void Log::logCreateFail(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
+	char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -217,7 +271,7 @@ void Log::logCreateFail(Address * address, bool isCoordinator, int transID, stri
  * DESCRIPTION: Call this function if READ failed
  */
 void Log::logReadFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -233,7 +287,7 @@ void Log::logReadFail(Address * address, bool isCoordinator, int transID, string
  * DESCRIPTION: Call this function if UPDATE failed
  */
 void Log::logUpdateFail(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -249,7 +303,7 @@ void Log::logUpdateFail(Address * address, bool isCoordinator, int transID, stri
  * DESCRIPTION: Call this function if DELETE failed
  */
 void Log::logDeleteFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+    char stdstring[100];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
@@ -10,6 +10,7 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include <mutex>
 
 /*
  * Macros
@@ -20,6 +21,16 @@
 #define DBG_LOG "dbg.log"
 #define STATS_LOG "stats.log"
 
+/**
+ * Struct Name: LogRecord
+ *
+ * DESCRIPTION: A line held back while its thread captures the log output
+ */
+typedef struct LogRecord {
+	Address addr;
+	string text;
+}LogRecord;
+
 /**
  * CLASS NAME: Log
  *
@@ -29,12 +40,20 @@ class Log{
 private:
 	Params *par;
 	bool firstTime;
+	// serializes the writes to the log files
+	static mutex writeLock;
+	// where this thread's lines go instead of the files, NULL when not capturing
+	static thread_local vector<LogRecord> *capture;
+	void write(Address *addr, const char *buffer);
 public:
 	Log(Params *p);
 	Log(const Log &anotherLog);
 	Log& operator = (const Log &anotherLog);
 	virtual ~Log();
 	void LOG(Address *, const char * str, ...);
+	static void beginCapture(vector<LogRecord> *records);
+	static void endCapture();
+	void flush(vector<LogRecord> &records);
 	void logNodeAdd(Address *, Address *);
 	void logNodeRemove(Address *, Address *);
 	// success
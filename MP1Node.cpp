@@ -25,6 +25,21 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
 	this->log = log;
 	this->par = params;
 	this->memberNode->addr = *address;
+	this->rngState = params->SEED ^ (EmulNet::addressId(address) * 2654435761u);
+	this->sentMessages = 0;
+	this->sentBytes = 0;
+	this->probeTarget = -1;
+	this->probeSeq = 0;
+	this->probeSentAt = 0;
+	this->probeAcked = false;
+	this->phiQuantile = phiQuantileOf(params->PHI_THRESHOLD);
+	this->digestsReceived = 0;
+	this->digestsMatched = 0;
+	this->pullBuckets = 0;
+	this->ringVersion = -1;
+	this->viewPending = -1;
+	this->viewPendingAt = 0;
+	this->beatTime = 0;
 }
 
 /**
@@ -102,6 +117,7 @@ int MP1Node::initThisNode(Address *joinaddr) {
     // node is up!
 	memberNode->nnb = 0;
 	memberNode->heartbeat = 0;
+	beatTime = par->globaltime;
 	memberNode->pingCounter = TFAIL;
 	memberNode->timeOutCounter = -1;
     initMemberListTable(memberNode);
@@ -115,9 +131,8 @@ int MP1Node::initThisNode(Address *joinaddr) {
  * DESCRIPTION: Join the distributed system
  */
 int MP1Node::introduceSelfToGroup(Address *joinaddr) {
-	MessageHdr *msg;
 #ifdef DEBUGLOG
-    static char s[1024];
+    char s[1024];
 #endif
 
     if ( 0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
@@ -130,13 +145,11 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 
     }
     else {
-        size_t msgsize = sizeof(MessageHdr) + sizeof(joinaddr->addr) + sizeof(long) + 1;
-        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-        // create JOINREQ message: format of data is {struct Address myaddr}
-        msg->msgType = JOINREQ;
-        memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-        memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
+        // create JOINREQ message: a frame whose only entry is this node
+        sendEntries.resize(1);
+        memcpy(&sendEntries[0].id, &memberNode->addr.addr[0], sizeof(int));
+        memcpy(&sendEntries[0].port, &memberNode->addr.addr[4], sizeof(short));
+        sendEntries[0].heartbeat = memberNode->heartbeat;
 
 #ifdef DEBUGLOG
         sprintf(s, "Trying to join...");
@@ -144,9 +157,7 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 #endif
 
         // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
-
-        free(msg);
+        sendFrames(joinaddr, JOINREQ, sendEntries);
     }
 
     return 1;
@@ -174,6 +185,14 @@ void MP1Node::nodeLoop() {
     	return;
     }
 
+    // Count the beats of the ticks this node was not run on before any message reads them
+    if( memberNode->inGroup ) {
+    	beatUntil(par->globaltime - 1);
+    }
+    else {
+    	beatTime = par->globaltime - 1;
+    }
+
     // Check my messages
     checkMessages();
 
@@ -203,6 +222,7 @@ void MP1Node::checkMessages() {
     	size = memberNode->mp1q.front().size;
     	memberNode->mp1q.pop();
     	recvCallBack((void *)memberNode, (char *)ptr, size);
+    	EmulNet::ENrelease((char *)ptr);
     }
     return;
 }
@@ -214,108 +234,190 @@ void MP1Node::checkMessages() {
  */
 bool MP1Node::recvCallBack(void *env, char *data, int size ) {
 	
-    MessageHdr * messageType = (MessageHdr *) data;
-    if(messageType->msgType == JOINREQ)
+    if(!Codec::isFrame(data, size))
     {
-       
-        long heartbeat = 0;
-        char * addr = (char *) malloc(sizeof(memberNode->addr.addr));
-
-        memcpy(addr,(char*)(messageType+1), sizeof(memberNode->addr.addr));
-        memcpy(&heartbeat, (char *)(messageType+1) + 1 + sizeof(memberNode->addr.addr), sizeof(long));
-        addToMembershipList(addr, heartbeat, par->globaltime);
-
-        #ifdef DEBUGLOG
-
-        Address *joinedAddress = constructAddress(addr);
-        log->logNodeAdd(&memberNode->addr, joinedAddress);
-
-        // char s[1024];
-        // sprintf(s, "heartbeat : %ld", heartbeat);
-        // log->LOG(&memberNode->addr, s);
-        #endif
-        // Send Join Reply message and all its membership info
-        sendSelfMembershipMessage(addr, JOINREP);
-
-        free(addr);
+        return false;
     }
-    else if(messageType->msgType == JOINREP)
+    int frameType = Codec::frameType(data);
+    if(frameType == SWIM_PING || frameType == SWIM_ACK || frameType == SWIM_PINGREQ || frameType == RING_BEAT ||
+            frameType == VIEW_KEEPALIVE)
     {
-        memberNode->inGroup = true;
-        updateMembershipList(messageType, size);
-
+        SwimMessage msg;
+        if(!Codec::decodeSwim(data, size, msg, recvUpdates))
+        {
+            return false;
+        }
+        swimReceive(&msg, recvUpdates);
+    }
+    else if(frameType >= VIEW_FORWARDJOIN && frameType <= VIEW_SHUFFLE_REPLY)
+    {
+        ViewMessage msg;
+        if(!Codec::decodeView(data, size, msg, recvKeys))
+        {
+            return false;
+        }
+        viewReceive(&msg, recvKeys);
+    }
+    else if(frameType == DIGEST || frameType == DIGEST_PULL)
+    {
+        int type;
+        Address sender;
+        if(!Codec::decodeDigest(data, size, type, &sender, recvWords))
+        {
+            return false;
+        }
+        receiveDigest(type, &sender, recvWords);
     }
-    else if(messageType->msgType == PING)
+    else
     {
-        updateMembershipList(messageType, size);
+        int type;
+        Address sender;
+        vector<WireEntry> &entries = recvEntries;
+        if(!Codec::decodeMembers(data, size, type, &sender, entries))
+        {
+            return false;
+        }
+        long source = memberKey(*(int *)&sender.addr[0], *(short *)&sender.addr[4]);
+
+        if(type == JOINREQ)
+        {
+            if(entries.size() != 1)
+            {
+                return false;
+            }
+            if(par->VIEW == HYPARVIEW_VIEW)
+            {
+                // the joiner takes a place in this node's active view and walks into others'
+                viewAddActive(source);
+                for (unsigned int k = 0; k < activeView.size(); k++)
+                {
+                    if(activeView[k].key != source)
+                    {
+                        viewSend(activeView[k].key, VIEW_FORWARDJOIN, VIEW_ARWL, 0, source, NULL);
+                    }
+                }
+            }
+            if(par->VIEW != HYPARVIEW_VIEW || par->VIEW_RING)
+            {
+                mergeMembers(entries, source);
+            }
+            if(par->DETECTOR == SWIM_DETECTOR || par->DETECTOR == RING_DETECTOR || (par->VIEW == HYPARVIEW_VIEW && par->VIEW_RING))
+            {
+                swimEnqueue(entries[0].id, entries[0].port, SWIM_ALIVE, entries[0].heartbeat);
+            }
+
+            if(par->VIEW == HYPARVIEW_VIEW && par->VIEW_RING)
+            {
+                // the list gives the joiner the members but not the news about them; without the
+                // queued updates it would not pass on joins its new neighbours never heard of
+                for (unsigned int k = 0; k < swimGossip.size(); k += SWIM_PIGGYBACK)
+                {
+                    swimSend(sender.addr, VIEW_KEEPALIVE, 0, memberNode->addr.addr, sender.addr, NULLADDR);
+                }
+            }
+
+            // Send Join Reply message and all its membership info
+            sendSelfMembershipMessage(sender.addr, JOINREP);
+        }
+        else if(type == JOINREP)
+        {
+            memberNode->inGroup = true;
+            if(par->VIEW == HYPARVIEW_VIEW)
+            {
+                viewAddActive(source);
+            }
+            if(par->VIEW != HYPARVIEW_VIEW || par->VIEW_RING)
+            {
+                mergeMembers(entries, source);
+            }
+        }
+        else if(type == PING || type == DELTA)
+        {
+            mergeMembers(entries, source);
+        }
     }
 
     return true;
 }
 
-void MP1Node::updateMembershipList(MessageHdr * data, int size)
+/**
+ * FUNCTION NAME: mergeMembers
+ *
+ * DESCRIPTION: Merges the entries of a membership frame into the list. source is the
+ * 				memberKey of the sender. Entries the list learns from, new ones and higher
+ * 				heartbeats, are stamped with this node's clock.
+ */
+void MP1Node::mergeMembers(vector<WireEntry> &entries, long source)
 {
-    int readMsgSize = sizeof(MessageHdr);
-    MembershipInfo * newMembershipInfo = (MembershipInfo *) malloc(sizeof(MembershipInfo));
-    
-    while(readMsgSize < size)
+    for (unsigned int i = 0; i < entries.size(); i++)
     {
-        memcpy(newMembershipInfo, (char*)data + readMsgSize, sizeof(MembershipInfo));
+        WireEntry &entry = entries[i];
 
         // check whether the reveived item in self membership
-        bool isnew = true;
-        int memberNumber = memberNode->memberList.size();
+        int slot = findMember(entry.id, entry.port);
 
-        for (int i = 0; i < memberNumber; i++)
+        if(slot < 0 && (par->DETECTOR == PHI_DETECTOR || par->GOSSIP_DIGEST > 0 || par->VIEW == HYPARVIEW_VIEW))
         {
-            if(isSameMemberInGroup(&memberNode->memberList[i], newMembershipInfo))
+            // gossip of a member this node removed, sent before the others gave up on it
+            unordered_map<long, long>::iterator dead = deadMembers.find(memberKey(entry.id, entry.port));
+            if(dead != deadMembers.end() && entry.heartbeat <= dead->second)
             {
-                isnew =false;
-                if(newMembershipInfo->heartbeat > memberNode->memberList[i].heartbeat)
-                {
-                    memberNode->memberList[i].heartbeat = newMembershipInfo->heartbeat;
-                    memberNode->memberList[i].timestamp = newMembershipInfo->timestamp ;
-                }
-
-                break;
+                continue;
             }
         }
 
-        if(isnew)
+        if(slot >= 0)
+        {
+            if(entry.heartbeat > memberNode->memberList[slot].heartbeat)
+            {
+                memberNode->memberList[slot].heartbeat = entry.heartbeat;
+                memberNode->memberList[slot].timestamp = par->globaltime;
+                memberNode->memberList[slot].changedAt = par->globaltime;
+                memberNode->memberList[slot].changedFrom = source;
+                armDeadline(slot);
+                // a newer incarnation refutes a suspicion
+                suspects.erase(memberKey(entry.id, entry.port));
+            }
+        }
+        else
         {
-            addToMembershipList(newMembershipInfo->id,
-                                newMembershipInfo->port,
-                                newMembershipInfo->heartbeat,
-                                newMembershipInfo->timestamp);
+            addToMembershipList(entry.id, entry.port, entry.heartbeat, par->globaltime);
+            memberNode->memberList.back().changedFrom = source;
 
-            if(!isSameAddress(newMembershipInfo->id, newMembershipInfo->port))
+            if(!isSameAddress(entry.id, entry.port))
             {
                 
                 #ifdef DEBUGLOG
                 
-                Address *joinedAddress = constructAddress(newMembershipInfo->id, newMembershipInfo->port);
-                log->logNodeAdd(&memberNode->addr, joinedAddress);
+                Address joinedAddress;
+                keyAddress(memberKey(entry.id, entry.port), &joinedAddress);
+                log->logNodeAdd(&memberNode->addr, &joinedAddress);
                 
                 #endif
             }
         }
-        
-        readMsgSize = readMsgSize + sizeof(MembershipInfo);
     }
-
-    free(newMembershipInfo);
-
 }
 
-bool MP1Node::isSameMemberInGroup(MemberListEntry *listEntry, MembershipInfo * reveivedMembershipInfo)
+/**
+ * FUNCTION NAME: memberKey
+ *
+ * DESCRIPTION: Key of a member in memberIndex, its id and port packed together
+ */
+long MP1Node::memberKey(int id, short port)
 {
-    if(reveivedMembershipInfo->id == listEntry->id && reveivedMembershipInfo->port == listEntry->port)
-    {
-        return true;
-    }
-
-    return false;
+    return ((long)id << 16) | (unsigned short)port;
+}
 
+/**
+ * FUNCTION NAME: findMember
+ *
+ * DESCRIPTION: Slot of the member in memberNode->memberList, or -1 if it is not in the list
+ */
+int MP1Node::findMember(int id, short port)
+{
+    unordered_map<long, int>::iterator it = memberIndex.find(memberKey(id, port));
+    return it == memberIndex.end() ? -1 : it->second;
 }
 
 void MP1Node::addToMembershipList(char * newMemberAddress, long heartbeat, int timestamp)
@@ -330,187 +432,1693 @@ void MP1Node::addToMembershipList(char * newMemberAddress, long heartbeat, int t
 void MP1Node::addToMembershipList(int id, int port, long heartbeat, int timestamp)
 {
     MemberListEntry memberEntry(id, port, heartbeat, timestamp);
+    memberEntry.changedAt = par->globaltime;
+    memberIndex[memberKey(id, port)] = memberNode->memberList.size();
     memberNode->memberList.push_back(memberEntry);
     memberNode->nnb ++ ;
+    armDeadline(memberNode->memberList.size() - 1);
+    addedIds.push_back(id);
+    publish(id, port, true);
 }
 
-void MP1Node::sendSelfMembershipMessage(char * targetAddress, MsgTypes type)
+/**
+ * FUNCTION NAME: publish
+ *
+ * DESCRIPTION: Tells the ring that a member joined or left the list
+ */
+void MP1Node::publish(int id, short port, bool joined)
 {
-    MessageHdr *msg;
-    int memberNumber = memberNode->memberList.size();
-    
-    int sendNumber = 0;
-    for(int i = 0; i < memberNumber;i++)
+    MembershipEvent event;
+    event.version = ++ memberNode->membershipVersion;
+    event.id = id;
+    event.port = port;
+    event.joined = joined;
+    memberNode->membershipEvents.push_back(event);
+}
+
+/**
+ * FUNCTION NAME: armDeadline
+ *
+ * DESCRIPTION: Sets the tick at which the member in slot gets removed unless heard of again.
+ * 				Called whenever its timestamp moves. The HYPARVIEW views set no deadlines,
+ * 				failures are found by the active neighbours. The heartbeat detector removes it the
+ * 				first tick more than TREMOVE after the timestamp; the PHI detector records the
+ * 				arrival and removes it the first tick its phi is above PHI_THRESHOLD.
+ */
+void MP1Node::armDeadline(int slot)
+{
+    MemberListEntry &entry = memberNode->memberList[slot];
+    long key = memberKey(entry.id, entry.port);
+
+    // a node counts its own beats and never times itself out
+    if(par->VIEW == HYPARVIEW_VIEW || isSameAddress(entry.id, entry.port))
+    {
+        return;
+    }
+    if(par->DETECTOR == HEARTBEAT_DETECTOR)
     {
-        if(par->globaltime - memberNode->memberList[i].timestamp > TFAIL)
+        deadlines.schedule(key, entry.timestamp + TREMOVE + 1);
+    }
+    else if(par->DETECTOR == PHI_DETECTOR)
+    {
+        PhiState &state = phiState[key];
+        if(state.intervals.empty())
         {
-            continue;
+            state.intervals.resize(par->PHI_WINDOW);
+            state.lastArrival = entry.timestamp;
+        }
+        else if(entry.timestamp > state.lastArrival)
+        {
+            phiArrival(state, entry.timestamp);
         }
+        deadlines.schedule(key, phiDeadline(state));
+    }
+}
+
+/**
+ * FUNCTION NAME: phiArrival
+ *
+ * DESCRIPTION: Adds the interval since the last heartbeat arrival to the window, dropping the
+ * 				oldest one once the window is full
+ */
+void MP1Node::phiArrival(PhiState &state, int time)
+{
+    int interval = time - state.lastArrival;
+    int window = state.intervals.size();
 
-        sendNumber ++;
+    if(state.count == window)
+    {
+        int oldest = state.intervals[state.next];
+        state.sum -= oldest;
+        state.sumSquares -= (double)oldest * oldest;
+    }
+    else
+    {
+        state.count ++;
+    }
+    state.intervals[state.next] = interval;
+    state.next = (state.next + 1) % window;
+    state.sum += interval;
+    state.sumSquares += (double)interval * interval;
+    state.lastArrival = time;
+}
+
+/**
+ * FUNCTION NAME: phiDeadline
+ *
+ * DESCRIPTION: First tick at which the member's phi exceeds PHI_THRESHOLD, if nothing arrives
+ * 				before. With the inter-arrival times taken as normal, phi(t) = -log10(P(interval > t))
+ * 				passes the threshold at mean + phiQuantile * stddev after the last arrival.
+ * 				Until PHI_MIN_SAMPLES intervals are known the fixed TREMOVE applies.
+ */
+int MP1Node::phiDeadline(PhiState &state)
+{
+    if(state.count < PHI_MIN_SAMPLES)
+    {
+        return state.lastArrival + TREMOVE + 1;
     }
 
-    size_t size = sizeof(MembershipInfo) * sendNumber + sizeof(MessageHdr);
+    double mean = state.sum / state.count;
+    double variance = max(0.0, state.sumSquares / state.count - mean * mean);
+    double deviation = max(sqrt(variance), PHI_MIN_STDDEV);
+    return state.lastArrival + (int)floor(mean + phiQuantile * deviation) + 1;
+}
+
+/**
+ * FUNCTION NAME: phi
+ *
+ * DESCRIPTION: Suspicion level of a member with that arrival history, elapsed ticks after the
+ * 				last arrival: -log10 of the probability that an interval lasts that long
+ */
+double MP1Node::phi(double mean, double deviation, double elapsed)
+{
+    double tail = 0.5 * erfc((elapsed - mean) / (deviation * sqrt(2.0)));
+    return tail > 0 ? -log10(tail) : HUGE_VAL;
+}
+
+/**
+ * FUNCTION NAME: phiQuantileOf
+ *
+ * DESCRIPTION: Standard deviations past the mean at which phi reaches threshold
+ */
+double MP1Node::phiQuantileOf(double threshold)
+{
+    double low = 0, high = 40;
+
+    // phi grows with the elapsed time, bisect on it
+    for (int k = 0; k < 100; k++)
+    {
+        double middle = (low + high) / 2;
+        if(phi(0, 1, middle) < threshold)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return high;
+}
 
-    msg = (MessageHdr *)malloc(size * sizeof(char));
-    msg->msgType = type;
+void MP1Node::sendSelfMembershipMessage(char * targetAddress, MsgTypes type)
+{
+    if(type == PING && par->GOSSIP_DIGEST > 0)
+    {
+        sendDigest(targetAddress);
+        return;
+    }
+    if(type == PING && par->GOSSIP_DELTA > 0)
+    {
+        sendDelta(targetAddress);
+        return;
+    }
 
-    int sendCount = 0;
+    sendEntries.clear();
+    int memberNumber = memberNode->memberList.size();
     for (int i = 0; i < memberNumber; i++)
     {
-        if(par->globaltime - memberNode->memberList[i].timestamp > TFAIL)
+        if(par->DETECTOR == HEARTBEAT_DETECTOR && par->VIEW == FULL_VIEW &&
+                par->globaltime - memberNode->memberList[i].timestamp > TFAIL + par->GOSSIP_DIGEST)
         {
             continue;
         }
 
-        MembershipInfo membershipInfo;
-        membershipInfo.id = memberNode->memberList[i].id;
-        membershipInfo.port = memberNode->memberList[i].port;
-        membershipInfo.heartbeat = memberNode->memberList[i].heartbeat;
-        membershipInfo.timestamp = memberNode->memberList[i].timestamp;
-        memcpy((char*)(msg + 1) + sizeof(MembershipInfo) * sendCount, &membershipInfo,sizeof(MembershipInfo));  
-
-        sendCount ++; 
+        WireEntry entry;
+        entry.id = memberNode->memberList[i].id;
+        entry.port = memberNode->memberList[i].port;
+        entry.heartbeat = memberNode->memberList[i].heartbeat;
+        sendEntries.push_back(entry);
     }
 
-    Address *toAddress = constructAddress(targetAddress);
-    emulNet->ENsend(&memberNode->addr, toAddress, (char *)msg, size);
+    Address toAddress;
+    memcpy(toAddress.addr, targetAddress, sizeof(toAddress.addr));
+    sendFrames(&toAddress, type, sendEntries);
+}
+
+/**
+ * FUNCTION NAME: sendFrames
+ *
+ * DESCRIPTION: Sends entries to one member in as many compact frames as fit in a message.
+ * 				entries gets sorted on the way.
+ */
+void MP1Node::sendFrames(Address *to, MsgTypes type, vector<WireEntry> &entries)
+{
+    int count = Codec::encodeMembers(type, &memberNode->addr, entries, par->MAX_MSG_SIZE - (int)sizeof(en_msg) - 1, sendFrameBuffers);
 
-    free(msg);
+    for (int i = 0; i < count; i++)
+    {
+        emulNet->ENsend(&memberNode->addr, to, sendFrameBuffers[i].data(), sendFrameBuffers[i].size());
+        sentMessages ++;
+        sentBytes += sendFrameBuffers[i].size();
+    }
 }
 
 /**
- * FUNCTION NAME: nodeLoopOps
+ * FUNCTION NAME: sendDelta
  *
- * DESCRIPTION: Check if any node hasn't responded within a timeout period and then delete
- * 				the nodes
- * 				Propagate your membership list
+ * DESCRIPTION: Gossips to one member only the entries that changed since the last gossip to it,
+ * 				leaving out the ones it told this node itself. Every GOSSIP_DELTA ticks, and to a
+ * 				member never gossiped to, the whole list goes out instead.
  */
-void MP1Node::nodeLoopOps() {
+void MP1Node::sendDelta(char * targetAddress)
+{
+    int id = 0;
+    short port = 0;
+    memcpy(&id, &targetAddress[0], sizeof(int));
+    memcpy(&port, &targetAddress[4], sizeof(short));
+    long peer = memberKey(id, port);
 
-    // increment node heartbeat
-    memberNode->heartbeat ++;
+    unordered_map<long, PeerState>::iterator it = peerState.find(peer);
+    bool full = it == peerState.end() || par->globaltime - it->second.lastFull >= par->GOSSIP_DELTA;
+    int since = it == peerState.end() ? -1 : it->second.lastSent;
 
-    // find self note in memberentry list, then increment its heartbeat
+    sendEntries.clear();
     int memberNumber = memberNode->memberList.size();
-
     for (int i = 0; i < memberNumber; i++)
     {
-        if(isSameAddress(memberNode->memberList[i].id, memberNode->memberList[i].port))
+        MemberListEntry &entry = memberNode->memberList[i];
+        if(par->globaltime - entry.timestamp > TFAIL)
+        {
+            continue;
+        }
+        if(!full && (entry.changedAt <= since || entry.changedFrom == peer))
         {
-            memberNode->memberList[i].heartbeat ++;
-            memberNode->memberList[i].timestamp = par->globaltime;
-            break;
+            continue;
         }
 
+        WireEntry wire;
+        wire.id = entry.id;
+        wire.port = entry.port;
+        wire.heartbeat = entry.heartbeat;
+        sendEntries.push_back(wire);
     }
 
-    // check if any node hasn't responded within a timeout period and then delete
-    for(memberNode->myPos = memberNode->memberList.begin(); memberNode->myPos != memberNode->memberList.end();)
+    Address toAddress;
+    memcpy(toAddress.addr, targetAddress, sizeof(toAddress.addr));
+    sendFrames(&toAddress, DELTA, sendEntries);
+
+    PeerState &state = peerState[peer];
+    state.lastSent = par->globaltime;
+    if(full)
     {
-        if( par->globaltime - (*(memberNode->myPos)).timestamp > TREMOVE)
-        {
-            #ifdef DEBUGLOG
-                Address *removedAddress = constructAddress((*(memberNode->myPos)).id, (*(memberNode->myPos)).port);
-                log->logNodeRemove(&memberNode->addr, removedAddress);
-            #endif
+        state.lastFull = par->globaltime;
+    }
+}
+
+/**
+ * FUNCTION NAME: sendDigest
+ *
+ * DESCRIPTION: Gossips to one member a digest of the list instead of the list: the list is cut
+ * 				into buckets by member, about DIGEST_BUCKET_SIZE members each, and every bucket
+ * 				is sent as a hash of its members' addresses and heartbeats. The member then
+ * 				exchanges the buckets it disagrees on.
+ */
+void MP1Node::sendDigest(char * targetAddress)
+{
+    int buckets = 1;
+    while(buckets < DIGEST_MAX_BUCKETS && buckets * DIGEST_BUCKET_SIZE < (int)memberNode->memberList.size())
+    {
+        buckets *= 2;
+    }
+    digestOf(buckets, digestWords);
+
+    Address toAddress;
+    memcpy(toAddress.addr, targetAddress, sizeof(toAddress.addr));
+    Codec::encodeDigest(DIGEST, &memberNode->addr, digestWords, digestFrame);
+    emulNet->ENsend(&memberNode->addr, &toAddress, digestFrame.data(), digestFrame.size());
+    sentMessages ++;
+    sentBytes += digestFrame.size();
+}
 
-            memberNode->myPos = memberNode->memberList.erase(memberNode->myPos);
+/**
+ * FUNCTION NAME: receiveDigest
+ *
+ * DESCRIPTION: Handles the digest frames. A DIGEST is compared bucket by bucket with this
+ * 				node's own list. The buckets that differ are exchanged both ways: this node sends
+ * 				its entries of them, and asks for the sender's with a DIGEST_PULL of the bucket
+ * 				count and a mask of them. A bucket already exchanged this tick is left to that
+ * 				exchange. A DIGEST_PULL is answered with the entries of the masked buckets.
+ */
+void MP1Node::receiveDigest(int type, Address *sender, vector<unsigned int> &words)
+{
+    if(type == DIGEST)
+    {
+        int buckets = words.size();
+        if(buckets < 1 || buckets > DIGEST_MAX_BUCKETS || (buckets & (buckets - 1)) != 0)
+        {
+            return;
         }
-        else
+        digestsReceived ++;
+        digestOf(buckets, digestWords);
+        if(pullBuckets != buckets)
         {
-            (memberNode->myPos)++;
+            pulledAt.assign(buckets, -1);
+            pullBuckets = buckets;
         }
 
-    }
-
-    // use gossip-style membership protocal to send self-membership info to other members in group randomly
-    double possibility = 0.4;
-    memberNumber = memberNode->memberList.size();
-    for (int i = 0; i < memberNumber; i++)
-    {
-        // do not send self message info to self
-        if(!isSameAddress(memberNode->memberList[i].id, memberNode->memberList[i].port))
+        unsigned long mask = 0;
+        bool matched = true;
+        for (int b = 0; b < buckets; b++)
         {
-            if((rand()%100 * 1.0) /100 > possibility )
+            if(digestWords[b] == words[b])
             {
-                Address *gossipAddress = constructAddress(memberNode->memberList[i].id, memberNode->memberList[i].port);
-                sendSelfMembershipMessage((*gossipAddress).addr, PING);
-
-                //#ifdef DEBUGLOG
-                //string source = memberNode->addr.getAddress();
-                //string target = gossipAddress.getAddress();
-                //cout << "Send Ping message from" <<  source << "to" << target << endl;
-                //#endif
+                continue;
+            }
+            matched = false;
+            if(pulledAt[b] != par->globaltime)
+            {
+                mask |= 1UL << b;
+                pulledAt[b] = par->globaltime;
             }
         }
+        if(matched)
+        {
+            digestsMatched ++;
+        }
+        if(mask == 0)
+        {
+            return;
+        }
 
+        sendBuckets(sender, buckets, mask);
+        digestWords.resize(3);
+        digestWords[0] = buckets;
+        digestWords[1] = (unsigned int)mask;
+        digestWords[2] = (unsigned int)(mask >> 32);
+        Codec::encodeDigest(DIGEST_PULL, &memberNode->addr, digestWords, digestFrame);
+        emulNet->ENsend(&memberNode->addr, sender, digestFrame.data(), digestFrame.size());
+        sentMessages ++;
+        sentBytes += digestFrame.size();
+    }
+    else if(type == DIGEST_PULL)
+    {
+        if(words.size() != 3 || words[0] < 1 || words[0] > DIGEST_MAX_BUCKETS || (words[0] & (words[0] - 1)) != 0)
+        {
+            return;
+        }
+        sendBuckets(sender, words[0], words[1] | ((unsigned long)words[2] << 32));
     }
-
-    return;
 }
 
-bool MP1Node::isSameAddress(int id, short port)
+/**
+ * FUNCTION NAME: sendBuckets
+ *
+ * DESCRIPTION: Sends one member this node's entries of the buckets in mask, as a PING
+ */
+void MP1Node::sendBuckets(Address *to, int buckets, unsigned long mask)
 {
-    Address *address = constructAddress(id, port);
-    return (memcmp(memberNode->addr.addr,address, 6) == 0 ? 1 : 0);   
+    sendEntries.clear();
+    int memberNumber = memberNode->memberList.size();
+    for (int i = 0; i < memberNumber; i++)
+    {
+        MemberListEntry &entry = memberNode->memberList[i];
+        if(par->DETECTOR == HEARTBEAT_DETECTOR && par->VIEW == FULL_VIEW && par->globaltime - entry.timestamp > TFAIL + par->GOSSIP_DIGEST)
+        {
+            continue;
+        }
+        if(!(mask & (1UL << digestBucket(entry.id, entry.port, buckets))))
+        {
+            continue;
+        }
+
+        WireEntry wire;
+        wire.id = entry.id;
+        wire.port = entry.port;
+        wire.heartbeat = entry.heartbeat;
+        sendEntries.push_back(wire);
+    }
+    if(!sendEntries.empty())
+    {
+        sendFrames(to, PING, sendEntries);
+    }
 }
 
 /**
- * FUNCTION NAME: isNullAddress
+ * FUNCTION NAME: digestOf
  *
- * DESCRIPTION: Function checks if the address is NULL
+ * DESCRIPTION: Digest of the list in buckets buckets: every member adds a hash of its address
+ * 				and heartbeat to its bucket, so the order of the list does not matter
  */
-int MP1Node::isNullAddress(Address *addr) {
-	return (memcmp(addr->addr, NULLADDR, 6) == 0 ? 1 : 0);
+void MP1Node::digestOf(int buckets, vector<unsigned int> &hashes)
+{
+    hashes.assign(buckets, 0);
+    int memberNumber = memberNode->memberList.size();
+    for (int i = 0; i < memberNumber; i++)
+    {
+        MemberListEntry &entry = memberNode->memberList[i];
+        unsigned long key = mix(memberKey(entry.id, entry.port));
+        hashes[key & (buckets - 1)] += (unsigned int)(mix(key ^ entry.heartbeat) >> 32);
+    }
 }
 
 /**
- * FUNCTION NAME: getJoinAddress
+ * FUNCTION NAME: digestBucket
  *
- * DESCRIPTION: Returns the Address of the coordinator
+ * DESCRIPTION: Bucket of a member in a digest of buckets buckets
  */
-Address MP1Node::getJoinAddress() {
-    Address joinaddr;
-
-    memset(&joinaddr, 0, sizeof(Address));
-    *(int *)(&joinaddr.addr) = 1;
-    *(short *)(&joinaddr.addr[4]) = 0;
-
-    return joinaddr;
+int MP1Node::digestBucket(int id, short port, int buckets)
+{
+    return mix(memberKey(id, port)) & (buckets - 1);
 }
 
 /**
- * FUNCTION NAME: initMemberListTable
+ * FUNCTION NAME: mix
  *
- * DESCRIPTION: Initialize the membership list
+ * DESCRIPTION: Spreads the bits of value over the whole word (the splitmix64 finalizer)
  */
-void MP1Node::initMemberListTable(Member *memberNode) {
-	memberNode->memberList.clear();
+unsigned long MP1Node::mix(unsigned long value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9UL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebUL;
+    return value ^ (value >> 31);
 }
 
 /**
- * FUNCTION NAME: printAddress
+ * FUNCTION NAME: nodeLoopOps
+ *
+ * DESCRIPTION: Check if any node hasn't responded within a timeout period and then delete
+ * 				the nodes
+ * 				Propagate your membership list
+ */
+void MP1Node::nodeLoopOps() {
+
+    if(par->VIEW == HYPARVIEW_VIEW)
+    {
+        viewTick();
+        return;
+    }
+    if(par->DETECTOR == SWIM_DETECTOR)
+    {
+        swimTick();
+        return;
+    }
+    if(par->DETECTOR == RING_DETECTOR)
+    {
+        ringTick();
+        return;
+    }
+
+    // increment node heartbeat, and the one in its own entry
+    beatUntil(par->globaltime);
+
+    // check if any node hasn't responded within a timeout period and then delete
+    removeFailedMembers();
+
+    if(par->GOSSIP == FANOUT_GOSSIP)
+    {
+        gossipToPeers();
+        return;
+    }
+
+    // use gossip-style membership protocal to send self-membership info to other members in group randomly
+    double possibility = 0.4;
+    int memberNumber = memberNode->memberList.size();
+    for (int i = 0; i < memberNumber; i++)
+    {
+        // do not send self message info to self
+        if(!isSameAddress(memberNode->memberList[i].id, memberNode->memberList[i].port))
+        {
+            if((rand_r(&rngState)%100 * 1.0) /100 > possibility )
+            {
+                Address gossipAddress;
+                keyAddress(memberKey(memberNode->memberList[i].id, memberNode->memberList[i].port), &gossipAddress);
+                sendSelfMembershipMessage(gossipAddress.addr, PING);
+
+                //#ifdef DEBUGLOG
+                //string source = memberNode->addr.getAddress();
+                //string target = gossipAddress.getAddress();
+                //cout << "Send Ping message from" <<  source << "to" << target << endl;
+                //#endif
+            }
+        }
+
+    }
+
+    return;
+}
+
+/**
+ * FUNCTION NAME: beatUntil
+ *
+ * DESCRIPTION: Raises the heartbeat once for every beat after the last one counted up to time,
+ * 				and stamps the node's own entry with the last of them. A node in the group
+ * 				beats every tick, or every GOSSIP_DIGEST ticks, so the heartbeat follows from
+ * 				the clock and the ticks the event scheduler skips count when the node next runs.
+ */
+void MP1Node::beatUntil(int time)
+{
+    int beats = time - beatTime;
+    int last = time;
+
+    // SWIM, RING and HYPARVIEW only raise it to refute a suspicion
+    if(par->VIEW == HYPARVIEW_VIEW || par->DETECTOR == SWIM_DETECTOR || par->DETECTOR == RING_DETECTOR)
+    {
+        beatTime = time;
+        return;
+    }
+    // with GOSSIP_DIGEST every node beats on the same ticks, so that the lists agree in between
+    if(par->GOSSIP_DIGEST > 0)
+    {
+        beats = time / par->GOSSIP_DIGEST - beatTime / par->GOSSIP_DIGEST;
+        last = time - time % par->GOSSIP_DIGEST;
+    }
+    beatTime = time;
+    if(beats <= 0)
+    {
+        return;
+    }
+
+    memberNode->heartbeat += beats;
+
+    int self = findMember(*(int *)&memberNode->addr.addr[0], *(short *)&memberNode->addr.addr[4]);
+    if(self >= 0)
+    {
+        memberNode->memberList[self].heartbeat += beats;
+        memberNode->memberList[self].timestamp = last;
+        memberNode->memberList[self].changedAt = last;
+        memberNode->memberList[self].changedFrom = -1;
+    }
+}
+
+/**
+ * FUNCTION NAME: nextTimer
+ *
+ * DESCRIPTION: Next tick on which this node has work of its own, messages aside: its FANOUT
+ * 				round or the first removal deadline with the heartbeat and PHI detectors, and the
+ * 				end of its probe period, a helper probe or a suspicion running out with SWIM. ALL
+ * 				gossip, the RING detector and the HYPARVIEW views act every tick. Running a
+ * 				node on a tick without any of these only counts its beat.
+ */
+int MP1Node::nextTimer()
+{
+    int now = par->globaltime;
+    int id = *(int *)&memberNode->addr.addr[0];
+    int next;
+
+    if(par->VIEW == HYPARVIEW_VIEW || par->DETECTOR == RING_DETECTOR)
+    {
+        return now + 1;
+    }
+    if(par->DETECTOR == SWIM_DETECTOR)
+    {
+        next = now + 1 + (par->SWIM_PERIOD - (now + 1 + id) % par->SWIM_PERIOD) % par->SWIM_PERIOD;
+        int helpers = probeSentAt + max(1, par->SWIM_PERIOD / 3);
+        if(probeTarget >= 0 && !probeAcked && helpers > now)
+        {
+            next = min(next, helpers);
+        }
+        for (unordered_map<long, int>::iterator it = suspects.begin(); it != suspects.end(); it++)
+        {
+            next = min(next, it->second + par->SWIM_SUSPECT);
+        }
+        return max(now + 1, next);
+    }
+    if(par->GOSSIP != FANOUT_GOSSIP)
+    {
+        return now + 1;
+    }
+
+    next = now + 1 + (par->GOSSIP_PERIOD - (now + 1 + id) % par->GOSSIP_PERIOD) % par->GOSSIP_PERIOD;
+    return max(now + 1, min(next, deadlines.nextDue()));
+}
+
+/**
+ * FUNCTION NAME: gossipToPeers
+ *
+ * DESCRIPTION: Sends the membership list to GOSSIP_FANOUT distinct random members, once every
+ * 				GOSSIP_PERIOD ticks. The nodes' rounds are spread over the period by id.
+ */
+void MP1Node::gossipToPeers()
+{
+    int id = *(int *)&memberNode->addr.addr[0];
+    if((par->globaltime + id) % par->GOSSIP_PERIOD != 0)
+    {
+        return;
+    }
+
+    randomMembers(par->GOSSIP_FANOUT, selfKey(), -1, picks);
+    for (unsigned int k = 0; k < picks.size(); k++)
+    {
+        Address gossipAddress;
+        MemberListEntry &peer = memberNode->memberList[picks[k]];
+        memcpy(&gossipAddress.addr[0], &peer.id, sizeof(int));
+        memcpy(&gossipAddress.addr[4], &peer.port, sizeof(short));
+        sendSelfMembershipMessage(gossipAddress.addr, PING);
+    }
+}
+
+/**
+ * FUNCTION NAME: selfKey
+ *
+ * DESCRIPTION: memberKey of this node
+ */
+long MP1Node::selfKey()
+{
+    return memberKey(*(int *)&memberNode->addr.addr[0], *(short *)&memberNode->addr.addr[4]);
+}
+
+/**
+ * FUNCTION NAME: keyAddress
+ *
+ * DESCRIPTION: Address of the member with that memberKey
+ */
+void MP1Node::keyAddress(long key, Address *addr)
+{
+    int id = key >> 16;
+    short port = key & 0xffff;
+    memcpy(&addr->addr[0], &id, sizeof(int));
+    memcpy(&addr->addr[4], &port, sizeof(short));
+}
+
+/**
+ * FUNCTION NAME: randomMembers
+ *
+ * DESCRIPTION: Fills slots with up to count distinct random members, other than the two excluded memberKeys
+ */
+void MP1Node::randomMembers(int count, long exclude1, long exclude2, vector<int> &slots)
+{
+    slots.clear();
+    int memberNumber = memberNode->memberList.size();
+    for (int i = 0; i < memberNumber; i++)
+    {
+        long key = memberKey(memberNode->memberList[i].id, memberNode->memberList[i].port);
+        if(key != exclude1 && key != exclude2)
+        {
+            slots.push_back(i);
+        }
+    }
+
+    // partial shuffle, the first count slots end up holding the chosen members
+    count = min(count, (int)slots.size());
+    for (int k = 0; k < count; k++)
+    {
+        int pick = k + rand_r(&rngState) % (slots.size() - k);
+        swap(slots[k], slots[pick]);
+    }
+    slots.resize(count);
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Deletes one member from the list, keeping the order of the others
+ */
+void MP1Node::removeMember(int slot)
+{
+    MemberListEntry entry = memberNode->memberList[slot];
+    long key = memberKey(entry.id, entry.port);
+
+    #ifdef DEBUGLOG
+        Address removedAddress;
+        keyAddress(key, &removedAddress);
+        log->logNodeRemove(&memberNode->addr, &removedAddress);
+    #endif
+
+    memberIndex.erase(key);
+    peerState.erase(key);
+    suspects.erase(key);
+    deadlines.cancel(key);
+    removedIds.push_back(entry.id);
+    publish(entry.id, entry.port, false);
+
+    memberNode->memberList.erase(memberNode->memberList.begin() + slot);
+    int memberNumber = memberNode->memberList.size();
+    for (int i = slot; i < memberNumber; i++)
+    {
+        memberIndex[memberKey(memberNode->memberList[i].id, memberNode->memberList[i].port)] = i;
+    }
+}
+
+/**
+ * FUNCTION NAME: swimTick
+ *
+ * DESCRIPTION: Per tick duties of the SWIM detector. Every SWIM_PERIOD ticks a node pings one
+ * 				random member. Without an ack after a third of the period it asks SWIM_K other
+ * 				members to ping the target for it, and without any ack by the end of the period
+ * 				the target becomes suspect. A suspect that does not refute within SWIM_SUSPECT
+ * 				ticks is removed. Changes travel piggybacked on these messages, so each node
+ * 				sends about the same number of messages whatever the size of the group.
+ */
+void MP1Node::swimTick()
+{
+    int now = par->globaltime;
+    int id = *(int *)&memberNode->addr.addr[0];
+
+    swimExpireSuspects();
+
+    Address target;
+    if(probeTarget >= 0 && !probeAcked && now - probeSentAt == max(1, par->SWIM_PERIOD / 3))
+    {
+        // no direct ack, probe through helpers
+        keyAddress(probeTarget, &target);
+        randomMembers(par->SWIM_K, selfKey(), probeTarget, picks);
+        for (unsigned int k = 0; k < picks.size(); k++)
+        {
+            Address helper;
+            MemberListEntry &entry = memberNode->memberList[picks[k]];
+            keyAddress(memberKey(entry.id, entry.port), &helper);
+            swimSend(helper.addr, SWIM_PINGREQ, probeSeq, memberNode->addr.addr, target.addr, NULLADDR);
+        }
+    }
+
+    if((now + id) % par->SWIM_PERIOD != 0)
+    {
+        return;
+    }
+
+    // end of the protocol period
+    if(probeTarget >= 0 && !probeAcked)
+    {
+        int slot = findMember(probeTarget >> 16, probeTarget & 0xffff);
+        if(slot >= 0)
+        {
+            swimSuspect(slot);
+        }
+    }
+    probeTarget = -1;
+
+    randomMembers(1, selfKey(), -1, picks);
+    if(picks.empty())
+    {
+        return;
+    }
+    MemberListEntry &entry = memberNode->memberList[picks[0]];
+    probeTarget = memberKey(entry.id, entry.port);
+    probeSeq ++;
+    probeSentAt = now;
+    probeAcked = false;
+    keyAddress(probeTarget, &target);
+    swimSend(target.addr, SWIM_PING, probeSeq, memberNode->addr.addr, target.addr, NULLADDR);
+}
+
+/**
+ * FUNCTION NAME: swimExpireSuspects
+ *
+ * DESCRIPTION: Removes the suspects that did not refute within SWIM_SUSPECT ticks and tells the group they are dead
+ */
+void MP1Node::swimExpireSuspects()
+{
+    int now = par->globaltime;
+
+    vector<long> expired;
+    for (unordered_map<long, int>::iterator it = suspects.begin(); it != suspects.end(); it++)
+    {
+        if(now - it->second >= par->SWIM_SUSPECT)
+        {
+            expired.push_back(it->first);
+        }
+    }
+    for (unsigned int k = 0; k < expired.size(); k++)
+    {
+        int slot = findMember(expired[k] >> 16, expired[k] & 0xffff);
+        if(slot >= 0)
+        {
+            MemberListEntry entry = memberNode->memberList[slot];
+            removeMember(slot);
+            deadMembers[expired[k]] = entry.heartbeat;
+            swimEnqueue(entry.id, entry.port, SWIM_DEAD, entry.heartbeat);
+        }
+        suspects.erase(expired[k]);
+    }
+}
+
+/**
+ * FUNCTION NAME: ringTick
+ *
+ * DESCRIPTION: Per tick duties of the RING detector. A node beats to its RING_K successors and
+ * 				RING_K predecessors on the hash ring, the nodes that hold its replicas and whose
+ * 				replicas it holds, and suspects a neighbour it has not heard from in RING_TIMEOUT
+ * 				ticks. Suspicions, refutations and deaths go through the SWIM machinery and ride
+ * 				on the beats, plus one random member per tick while there are updates to spread.
+ * 				Each node sends about 2 RING_K messages a tick whatever the size of the group.
+ */
+void MP1Node::ringTick()
+{
+    swimExpireSuspects();
+    ringRefresh();
+
+    expiredKeys.clear();
+    deadlines.advance(par->globaltime, expiredKeys);
+    for (unsigned int k = 0; k < expiredKeys.size(); k++)
+    {
+        int slot = findMember(expiredKeys[k] >> 16, expiredKeys[k] & 0xffff);
+        if(slot >= 0)
+        {
+            swimSuspect(slot);
+        }
+    }
+
+    Address target;
+    for (unsigned int k = 0; k < ringNeighbours.size(); k++)
+    {
+        keyAddress(ringNeighbours[k], &target);
+        swimSend(target.addr, RING_BEAT, 0, memberNode->addr.addr, target.addr, NULLADDR);
+    }
+
+    // the neighbours alone would carry an update around the ring one hop a tick
+    if(!swimGossip.empty())
+    {
+        randomMembers(1, selfKey(), -1, picks);
+        if(!picks.empty())
+        {
+            MemberListEntry &entry = memberNode->memberList[picks[0]];
+            keyAddress(memberKey(entry.id, entry.port), &target);
+            swimSend(target.addr, RING_BEAT, 0, memberNode->addr.addr, target.addr, NULLADDR);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: ringRefresh
+ *
+ * DESCRIPTION: Recomputes the neighbours after the list changed. The ring is the one MP2Node
+ * 				builds, the members sorted by the hash code of their Node; members of equal hash
+ * 				code, rare among RING_SIZE positions, go by memberKey here. A member that stops
+ * 				being a neighbour is no longer watched, and a new one gets RING_TIMEOUT ticks
+ * 				to be heard from.
+ */
+void MP1Node::ringRefresh()
+{
+    if(ringVersion == memberNode->membershipVersion)
+    {
+        return;
+    }
+    ringVersion = memberNode->membershipVersion;
+
+    ringOrder.clear();
+    for (unsigned int i = 0; i < memberNode->memberList.size(); i++)
+    {
+        Address address;
+        long key = memberKey(memberNode->memberList[i].id, memberNode->memberList[i].port);
+        keyAddress(key, &address);
+        Node node(address);
+        ringOrder.push_back(make_pair(node.getHashCode(), key));
+    }
+    sort(ringOrder.begin(), ringOrder.end());
+
+    ringNext.clear();
+    int size = ringOrder.size();
+    int self = 0;
+    while (self < size && ringOrder[self].second != selfKey())
+    {
+        self ++;
+    }
+    for (int d = 1; self < size && d <= par->RING_K; d++)
+    {
+        long around[2] = { ringOrder[(self + d) % size].second, ringOrder[((self - d) % size + size) % size].second };
+        for (int k = 0; k < 2; k++)
+        {
+            if(around[k] != selfKey() && find(ringNext.begin(), ringNext.end(), around[k]) == ringNext.end())
+            {
+                ringNext.push_back(around[k]);
+            }
+        }
+    }
+
+    for (unsigned int k = 0; k < ringNeighbours.size(); k++)
+    {
+        if(find(ringNext.begin(), ringNext.end(), ringNeighbours[k]) == ringNext.end())
+        {
+            deadlines.cancel(ringNeighbours[k]);
+        }
+    }
+    for (unsigned int k = 0; k < ringNext.size(); k++)
+    {
+        if(!isRingNeighbour(ringNext[k]))
+        {
+            deadlines.schedule(ringNext[k], par->globaltime + par->RING_TIMEOUT + 1);
+        }
+    }
+    ringNeighbours.swap(ringNext);
+}
+
+/**
+ * FUNCTION NAME: isRingNeighbour
+ *
+ * DESCRIPTION: Whether this node watches the member of memberKey key
+ */
+bool MP1Node::isRingNeighbour(long key)
+{
+    return find(ringNeighbours.begin(), ringNeighbours.end(), key) != ringNeighbours.end();
+}
+
+/**
+ * FUNCTION NAME: viewTick
+ *
+ * DESCRIPTION: Per tick duties of the HYPARVIEW views. Active neighbours are links in both
+ * 				directions: a node keeps them alive with a keepalive every VIEW_KEEPALIVE idle
+ * 				ticks, and drops one it has not heard from in VIEW_MISSED periods. It refills
+ * 				its active view from the passive one, one NEIGHBOR request at a time, and every
+ * 				VIEW_SHUFFLE ticks swaps a sample of its views with the end of a random walk,
+ * 				which keeps the passive views fresh. With VIEW_RING a dropped neighbour also
+ * 				becomes a SWIM suspect of the full set, the set's updates ride on the
+ * 				keepalives, sent every tick while there are any, and every VIEW_SHUFFLE ticks
+ * 				the set is compared with a random neighbour's by digest.
+ */
+void MP1Node::viewTick()
+{
+    int now = par->globaltime;
+    int id = *(int *)&memberNode->addr.addr[0];
+    Address target;
+
+    if(par->VIEW_RING)
+    {
+        swimExpireSuspects();
+    }
+
+    for (int k = activeView.size() - 1; k >= 0; k--)
+    {
+        if(now - activeView[k].heardAt <= VIEW_MISSED * par->VIEW_KEEPALIVE)
+        {
+            continue;
+        }
+        long key = activeView[k].key;
+        activeView.erase(activeView.begin() + k);
+        int slot = findMember(key >> 16, key & 0xffff);
+        if(par->VIEW_RING && slot >= 0)
+        {
+            swimSuspect(slot);
+        }
+    }
+
+    if(viewPending >= 0 && now - viewPendingAt > VIEW_MISSED * par->VIEW_KEEPALIVE)
+    {
+        // no answer, the member is likely gone
+        viewRemovePassive(viewPending);
+        viewPending = -1;
+    }
+    if(viewPending < 0 && (int)activeView.size() < par->VIEW_ACTIVE && !passiveView.empty())
+    {
+        viewPending = passiveView[rand_r(&rngState) % passiveView.size()];
+        viewPendingAt = now;
+        // a node without neighbours must not be turned down
+        viewSend(viewPending, VIEW_NEIGHBOR, 0, activeView.empty(), selfKey(), NULL);
+    }
+
+    if((now + id) % par->VIEW_SHUFFLE == 0 && !activeView.empty())
+    {
+        viewKeys.clear();
+        for (unsigned int k = 0; k < activeView.size(); k++)
+        {
+            viewKeys.push_back(activeView[k].key);
+        }
+        viewSample.clear();
+        viewSample.push_back(selfKey());
+        viewSampleOf(viewKeys, VIEW_SHUFFLE_ACTIVE, viewSample);
+        viewSampleOf(passiveView, VIEW_SHUFFLE_PASSIVE, viewSample);
+        viewSend(viewRandomActive(-1, -1), VIEW_SHUFFLE, VIEW_ARWL, 0, selfKey(), &viewSample);
+    }
+
+    if(par->VIEW_RING && (now + id) % par->VIEW_SHUFFLE == par->VIEW_SHUFFLE / 2 && !activeView.empty())
+    {
+        // updates missed while the overlay changed under them are found by comparing digests
+        keyAddress(viewRandomActive(-1, -1), &target);
+        sendDigest(target.addr);
+    }
+
+    for (unsigned int k = 0; k < activeView.size(); k++)
+    {
+        if(swimGossip.empty() && now - activeView[k].sentAt < par->VIEW_KEEPALIVE)
+        {
+            continue;
+        }
+        keyAddress(activeView[k].key, &target);
+        swimSend(target.addr, VIEW_KEEPALIVE, 0, memberNode->addr.addr, target.addr, NULLADDR);
+        activeView[k].sentAt = now;
+    }
+}
+
+/**
+ * FUNCTION NAME: viewReceive
+ *
+ * DESCRIPTION: Handles a HYPARVIEW message. A FORWARDJOIN walks on until its hops run out or it
+ * 				reaches a node with no other neighbour, which takes the joiner into its active
+ * 				view; the node VIEW_PRWL hops before the end keeps it as passive. A SHUFFLE walks
+ * 				the same way, and its last node answers with as many of its passive members and
+ * 				keeps the shuffler's sample as passive, as the shuffler does with the answer.
+ */
+void MP1Node::viewReceive(ViewMessage *msg, vector<long> &keys)
+{
+    int count = keys.size();
+    long sender = msg->sender;
+
+    viewHeard(sender);
+
+    if(msg->type == VIEW_FORWARDJOIN)
+    {
+        long next = msg->ttl > 0 ? viewRandomActive(sender, msg->origin) : -1;
+        if(msg->origin == selfKey())
+        {
+            return;
+        }
+        if(next < 0)
+        {
+            viewAddActive(msg->origin);
+            viewSend(msg->origin, VIEW_NEIGHBOR, 0, 1, selfKey(), NULL);
+            return;
+        }
+        if(msg->ttl == VIEW_PRWL)
+        {
+            viewAddPassive(msg->origin);
+        }
+        viewSend(next, VIEW_FORWARDJOIN, msg->ttl - 1, 0, msg->origin, NULL);
+    }
+    else if(msg->type == VIEW_NEIGHBOR)
+    {
+        bool accept = msg->flag || (int)activeView.size() < par->VIEW_ACTIVE || viewFindActive(sender) >= 0;
+        if(accept)
+        {
+            viewAddActive(sender);
+        }
+        viewSend(sender, VIEW_NEIGHBOR_REPLY, 0, accept, selfKey(), NULL);
+    }
+    else if(msg->type == VIEW_NEIGHBOR_REPLY)
+    {
+        if(sender == viewPending)
+        {
+            viewPending = -1;
+        }
+        if(msg->flag)
+        {
+            viewAddActive(sender);
+        }
+    }
+    else if(msg->type == VIEW_DISCONNECT)
+    {
+        int k = viewFindActive(sender);
+        if(k >= 0)
+        {
+            activeView.erase(activeView.begin() + k);
+        }
+        viewAddPassive(sender);
+    }
+    else if(msg->type == VIEW_SHUFFLE)
+    {
+        long next = msg->ttl > 0 ? viewRandomActive(sender, msg->origin) : -1;
+        if(next >= 0)
+        {
+            viewKeys.assign(keys.begin(), keys.end());
+            viewSend(next, VIEW_SHUFFLE, msg->ttl - 1, 0, msg->origin, &viewKeys);
+            return;
+        }
+        if(msg->origin == selfKey())
+        {
+            return;
+        }
+        viewSample.clear();
+        viewSampleOf(passiveView, count, viewSample);
+        viewSend(msg->origin, VIEW_SHUFFLE_REPLY, 0, 0, selfKey(), &viewSample);
+        for (int k = 0; k < count; k++)
+        {
+            viewAddPassive(keys[k]);
+        }
+    }
+    else if(msg->type == VIEW_SHUFFLE_REPLY)
+    {
+        for (int k = 0; k < count; k++)
+        {
+            viewAddPassive(keys[k]);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: viewSend
+ *
+ * DESCRIPTION: Sends a HYPARVIEW message carrying keys, if not null
+ */
+void MP1Node::viewSend(long to, MsgTypes type, int ttl, int flag, long origin, vector<long> *keys)
+{
+    ViewMessage msg;
+    msg.type = type;
+    msg.ttl = ttl;
+    msg.flag = flag;
+    msg.sender = selfKey();
+    msg.origin = origin;
+    Codec::encodeView(msg, keys ? keys->data() : NULL, keys ? keys->size() : 0, viewBuffer);
+    int size = viewBuffer.size();
+
+    Address toAddress;
+    keyAddress(to, &toAddress);
+    emulNet->ENsend(&memberNode->addr, &toAddress, viewBuffer.data(), size);
+    sentMessages ++;
+    sentBytes += size;
+}
+
+/**
+ * FUNCTION NAME: viewAddActive
+ *
+ * DESCRIPTION: Makes a member an active neighbour. When the view is full a random neighbour
+ * 				makes room: it is told to drop this node and moves to the passive view.
+ */
+void MP1Node::viewAddActive(long key)
+{
+    if(key == selfKey() || viewFindActive(key) >= 0)
+    {
+        return;
+    }
+    viewRemovePassive(key);
+
+    if((int)activeView.size() >= par->VIEW_ACTIVE)
+    {
+        int k = rand_r(&rngState) % activeView.size();
+        long dropped = activeView[k].key;
+        activeView.erase(activeView.begin() + k);
+        viewSend(dropped, VIEW_DISCONNECT, 0, 0, selfKey(), NULL);
+        viewAddPassive(dropped);
+    }
+
+    ViewPeer peer;
+    peer.key = key;
+    peer.heardAt = par->globaltime;
+    peer.sentAt = par->globaltime;
+    activeView.push_back(peer);
+}
+
+/**
+ * FUNCTION NAME: viewAddPassive
+ *
+ * DESCRIPTION: Keeps a member in the passive view, unless it is this node or active. When the
+ * 				view is full a random member makes room.
+ */
+void MP1Node::viewAddPassive(long key)
+{
+    if(key == selfKey() || viewFindActive(key) >= 0 || find(passiveView.begin(), passiveView.end(), key) != passiveView.end())
+    {
+        return;
+    }
+    if((int)passiveView.size() >= par->VIEW_PASSIVE)
+    {
+        passiveView[rand_r(&rngState) % passiveView.size()] = key;
+        return;
+    }
+    passiveView.push_back(key);
+}
+
+/**
+ * FUNCTION NAME: viewRemovePassive
+ *
+ * DESCRIPTION: Drops a member from the passive view, if it is there
+ */
+void MP1Node::viewRemovePassive(long key)
+{
+    vector<long>::iterator it = find(passiveView.begin(), passiveView.end(), key);
+    if(it != passiveView.end())
+    {
+        *it = passiveView.back();
+        passiveView.pop_back();
+    }
+}
+
+/**
+ * FUNCTION NAME: viewFindActive
+ *
+ * DESCRIPTION: Index of a member in the active view, -1 if it is not there
+ */
+int MP1Node::viewFindActive(long key)
+{
+    for (unsigned int k = 0; k < activeView.size(); k++)
+    {
+        if(activeView[k].key == key)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/**
+ * FUNCTION NAME: viewRandomActive
  *
- * DESCRIPTION: Print the Address
+ * DESCRIPTION: A random active neighbour other than exclude1 and exclude2, -1 if there is none
  */
-void MP1Node::printAddress(Address *addr)
+long MP1Node::viewRandomActive(long exclude1, long exclude2)
 {
-    printf("%d.%d.%d.%d:%d \n",  addr->addr[0],addr->addr[1],addr->addr[2],
-                                                       addr->addr[3], *(short*)&addr->addr[4]) ;    
+    int candidates = 0;
+    long pick = -1;
+
+    // reservoir sampling over the few neighbours left
+    for (unsigned int k = 0; k < activeView.size(); k++)
+    {
+        if(activeView[k].key == exclude1 || activeView[k].key == exclude2)
+        {
+            continue;
+        }
+        candidates ++;
+        if(rand_r(&rngState) % candidates == 0)
+        {
+            pick = activeView[k].key;
+        }
+    }
+    return pick;
+}
+
+/**
+ * FUNCTION NAME: viewSampleOf
+ *
+ * DESCRIPTION: Appends up to count distinct random members of keys to out. keys is shuffled in part.
+ */
+void MP1Node::viewSampleOf(vector<long> &keys, int count, vector<long> &out)
+{
+    int size = keys.size();
+    for (int k = 0; k < count && k < size; k++)
+    {
+        int j = k + rand_r(&rngState) % (size - k);
+        swap(keys[k], keys[j]);
+        out.push_back(keys[k]);
+    }
+}
+
+/**
+ * FUNCTION NAME: viewHeard
+ *
+ * DESCRIPTION: Notes that an active neighbour was heard from
+ */
+void MP1Node::viewHeard(long key)
+{
+    int k = viewFindActive(key);
+    if(k >= 0)
+    {
+        activeView[k].heardAt = par->globaltime;
+    }
+}
+
+/**
+ * FUNCTION NAME: swimReceive
+ *
+ * DESCRIPTION: Handles a SWIM message: applies its updates, then takes an active neighbour's
+ * 				keepalive or a ring neighbour's beat, answers a ping, runs a ping for another member, or takes an ack for its
+ * 				own or a relayed probe
+ */
+void MP1Node::swimReceive(SwimMessage *msg, vector<SwimUpdate> &updates)
+{
+    SwimUpdate update;
+    for (unsigned int k = 0; k < updates.size(); k++)
+    {
+        swimApply(&updates[k]);
+    }
+
+    // a member whose join passed this node by is known from its own probes
+    memcpy(&update.id, &msg->origin[0], sizeof(int));
+    memcpy(&update.port, &msg->origin[4], sizeof(short));
+    if(findMember(update.id, update.port) < 0 && (par->VIEW == FULL_VIEW || par->VIEW_RING))
+    {
+        update.state = SWIM_ALIVE;
+        update.incarnation = 0;
+        swimApply(&update);
+    }
+
+    if(msg->type == VIEW_KEEPALIVE)
+    {
+        viewHeard(memberKey(update.id, update.port));
+    }
+    else if(msg->type == RING_BEAT)
+    {
+        long key = memberKey(update.id, update.port);
+        if(isRingNeighbour(key))
+        {
+            deadlines.schedule(key, par->globaltime + par->RING_TIMEOUT + 1);
+        }
+    }
+    else if(msg->type == SWIM_PING)
+    {
+        // the ack goes back the way the ping came
+        char *to = memcmp(msg->relay, NULLADDR, sizeof(NULLADDR)) == 0 ? msg->origin : msg->relay;
+        swimSend(to, SWIM_ACK, msg->seq, msg->origin, msg->target, msg->relay);
+    }
+    else if(msg->type == SWIM_PINGREQ)
+    {
+        swimSend(msg->target, SWIM_PING, msg->seq, msg->origin, msg->target, memberNode->addr.addr);
+    }
+    else if(memcmp(msg->origin, memberNode->addr.addr, sizeof(msg->origin)) == 0)
+    {
+        Address target;
+        memcpy(target.addr, msg->target, sizeof(target.addr));
+        if(msg->seq == probeSeq && probeTarget == memberKey(*(int *)&target.addr[0], *(short *)&target.addr[4]))
+        {
+            probeAcked = true;
+        }
+    }
+    else
+    {
+        swimSend(msg->origin, SWIM_ACK, msg->seq, msg->origin, msg->target, msg->relay);
+    }
+}
+
+/**
+ * FUNCTION NAME: swimApply
+ *
+ * DESCRIPTION: Applies one piggybacked update. Anything this node learns from it is passed on.
+ */
+void MP1Node::swimApply(SwimUpdate *update)
+{
+    long key = memberKey(update->id, update->port);
+
+    if(key == selfKey())
+    {
+        // refute a suspicion of this node with a newer incarnation
+        int self = findMember(update->id, update->port);
+        if(self >= 0 && update->state != SWIM_ALIVE && update->incarnation >= memberNode->memberList[self].heartbeat)
+        {
+            memberNode->memberList[self].heartbeat = update->incarnation + 1;
+            memberNode->heartbeat = update->incarnation + 1;
+            swimEnqueue(update->id, update->port, SWIM_ALIVE, update->incarnation + 1);
+        }
+        return;
+    }
+
+    int slot = findMember(update->id, update->port);
+    if(update->state == SWIM_ALIVE)
+    {
+        if(slot < 0)
+        {
+            unordered_map<long, long>::iterator dead = deadMembers.find(key);
+            if(dead != deadMembers.end() && update->incarnation <= dead->second)
+            {
+                return;
+            }
+            deadMembers.erase(key);
+            addToMembershipList(update->id, update->port, update->incarnation, par->globaltime);
+
+            #ifdef DEBUGLOG
+                Address joinedAddress;
+                keyAddress(key, &joinedAddress);
+                log->logNodeAdd(&memberNode->addr, &joinedAddress);
+            #endif
+        }
+        else if(update->incarnation > memberNode->memberList[slot].heartbeat)
+        {
+            memberNode->memberList[slot].heartbeat = update->incarnation;
+            memberNode->memberList[slot].timestamp = par->globaltime;
+            suspects.erase(key);
+        }
+        else
+        {
+            return;
+        }
+    }
+    else if(update->state == SWIM_SUSPECT)
+    {
+        if(slot < 0 || update->incarnation < memberNode->memberList[slot].heartbeat ||
+                (update->incarnation == memberNode->memberList[slot].heartbeat && suspects.count(key)))
+        {
+            return;
+        }
+        memberNode->memberList[slot].heartbeat = update->incarnation;
+        suspects[key] = par->globaltime;
+    }
+    else
+    {
+        if(slot < 0 || update->incarnation < memberNode->memberList[slot].heartbeat)
+        {
+            return;
+        }
+        removeMember(slot);
+        deadMembers[key] = update->incarnation;
+    }
+
+    swimEnqueue(update->id, update->port, update->state, update->incarnation);
+}
+
+/**
+ * FUNCTION NAME: swimSuspect
+ *
+ * DESCRIPTION: Marks a member that missed its probe as suspect and tells the group. The member
+ * 				itself is told right away too: gossip alone may reach it only after the timeout.
+ */
+void MP1Node::swimSuspect(int slot)
+{
+    MemberListEntry &entry = memberNode->memberList[slot];
+    long key = memberKey(entry.id, entry.port);
+    Address target;
+
+    if(suspects.count(key))
+    {
+        return;
+    }
+    suspects[key] = par->globaltime;
+    swimEnqueue(entry.id, entry.port, SWIM_SUSPECT, entry.heartbeat);
+
+    keyAddress(key, &target);
+    swimSend(target.addr, SWIM_PING, 0, memberNode->addr.addr, target.addr, NULLADDR);
+}
+
+/**
+ * FUNCTION NAME: swimEnqueue
+ *
+ * DESCRIPTION: Queues an update for piggybacking, replacing an older one about the same member.
+ * 				It rides on about 3 log N messages.
+ */
+void MP1Node::swimEnqueue(int id, short port, int state, long incarnation)
+{
+    SwimGossip gossip;
+    gossip.update.id = id;
+    gossip.update.port = port;
+    gossip.update.state = state;
+    gossip.update.incarnation = incarnation;
+    gossip.sendsLeft = 3 * (int)ceil(log2(memberNode->memberList.size() + 1));
+
+    for (unsigned int k = 0; k < swimGossip.size(); k++)
+    {
+        if(swimGossip[k].update.id == id && swimGossip[k].update.port == port)
+        {
+            swimGossip[k] = gossip;
+            return;
+        }
+    }
+    swimGossip.push_back(gossip);
+}
+
+/**
+ * FUNCTION NAME: swimSend
+ *
+ * DESCRIPTION: Sends a SWIM message carrying the SWIM_PIGGYBACK queued updates sent the fewest times
+ */
+void MP1Node::swimSend(char *to, MsgTypes type, int seq, char *origin, char *target, char *relay)
+{
+    // stable insertion sort, most sends left first; the queue is short, and stable_sort would allocate
+    for (unsigned int i = 1; i < swimGossip.size(); i++)
+    {
+        SwimGossip gossip = swimGossip[i];
+        int j = i;
+        for (; j > 0 && swimGossip[j - 1].sendsLeft < gossip.sendsLeft; j--)
+        {
+            swimGossip[j] = swimGossip[j - 1];
+        }
+        swimGossip[j] = gossip;
+    }
+    int count = min(SWIM_PIGGYBACK, (int)swimGossip.size());
+
+    SwimMessage msg;
+    msg.type = type;
+    msg.seq = seq;
+    memcpy(msg.origin, origin, sizeof(msg.origin));
+    memcpy(msg.target, target, sizeof(msg.target));
+    memcpy(msg.relay, relay, sizeof(msg.relay));
+    sendUpdates.clear();
+    for (int k = 0; k < count; k++)
+    {
+        sendUpdates.push_back(swimGossip[k].update);
+        swimGossip[k].sendsLeft --;
+    }
+    swimGossip.erase(remove_if(swimGossip.begin(), swimGossip.end(),
+            [](const SwimGossip &gossip) { return gossip.sendsLeft <= 0; }), swimGossip.end());
+    Codec::encodeSwim(msg, sendUpdates, swimBuffer);
+    int size = swimBuffer.size();
+
+    Address toAddress;
+    memcpy(toAddress.addr, to, sizeof(toAddress.addr));
+    emulNet->ENsend(&memberNode->addr, &toAddress, swimBuffer.data(), size);
+    sentMessages ++;
+    sentBytes += size;
+}
+
+/**
+ * FUNCTION NAME: removeFailedMembers
+ *
+ * DESCRIPTION: Deletes the members not heard of for TREMOVE, the ones whose deadline came due
+ * 				this tick. Nothing else is looked at unless one did. The rest move up in place,
+ * 				so the list keeps its order, and memberIndex follows the ones that moved.
+ */
+void MP1Node::removeFailedMembers()
+{
+    memberNode->myPos = memberNode->memberList.end();
+
+    expiredKeys.clear();
+    deadlines.advance(par->globaltime, expiredKeys);
+    if(expiredKeys.empty())
+    {
+        return;
+    }
+
+    expiredSlots.clear();
+    for (unsigned int k = 0; k < expiredKeys.size(); k++)
+    {
+        int slot = findMember(expiredKeys[k] >> 16, expiredKeys[k] & 0xffff);
+        if(slot >= 0)
+        {
+            expiredSlots.push_back(slot);
+        }
+    }
+    sort(expiredSlots.begin(), expiredSlots.end());
+
+    int memberNumber = memberNode->memberList.size();
+    unsigned int next = 0;
+    int kept = expiredSlots.empty() ? memberNumber : expiredSlots[0];
+
+    for (int i = kept; i < memberNumber; i++)
+    {
+        MemberListEntry &entry = memberNode->memberList[i];
+        if(next < expiredSlots.size() && expiredSlots[next] == i)
+        {
+            #ifdef DEBUGLOG
+                Address removedAddress;
+                keyAddress(memberKey(entry.id, entry.port), &removedAddress);
+                log->logNodeRemove(&memberNode->addr, &removedAddress);
+            #endif
+
+            memberIndex.erase(memberKey(entry.id, entry.port));
+            peerState.erase(memberKey(entry.id, entry.port));
+            removedIds.push_back(entry.id);
+            publish(entry.id, entry.port, false);
+            if(par->DETECTOR == PHI_DETECTOR)
+            {
+                phiState.erase(memberKey(entry.id, entry.port));
+            }
+            if(par->DETECTOR == PHI_DETECTOR || par->GOSSIP_DIGEST > 0)
+            {
+                // stale entries still travel for TFAIL + GOSSIP_DIGEST ticks, do not take them back
+                deadMembers[memberKey(entry.id, entry.port)] = entry.heartbeat;
+            }
+            next ++;
+            continue;
+        }
+
+        if(kept != i)
+        {
+            memberNode->memberList[kept] = entry;
+            memberIndex[memberKey(entry.id, entry.port)] = kept;
+        }
+        kept ++;
+    }
+
+    memberNode->memberList.erase(memberNode->memberList.begin() + kept, memberNode->memberList.end());
+    memberNode->myPos = memberNode->memberList.end();
+}
+
+bool MP1Node::isSameAddress(int id, short port)
+{
+    return (memcmp(&memberNode->addr.addr[0], &id, sizeof(int)) == 0 && memcmp(&memberNode->addr.addr[4], &port, sizeof(short)) == 0);
+}
+
+/**
+ * FUNCTION NAME: knows
+ *
+ * DESCRIPTION: Whether the member is in this node's membership list
+ */
+bool MP1Node::knows(int id, short port)
+{
+    return findMember(id, port) >= 0;
+}
+
+/**
+ * FUNCTION NAME: getSentMessages
+ *
+ * DESCRIPTION: Number of MP1 messages this node sent
+ */
+long MP1Node::getSentMessages()
+{
+    return sentMessages;
+}
+
+/**
+ * FUNCTION NAME: getSentBytes
+ *
+ * DESCRIPTION: Bytes of the MP1 messages this node sent
+ */
+long MP1Node::getSentBytes()
+{
+    return sentBytes;
+}
+
+/**
+ * FUNCTION NAME: getDigestsReceived
+ *
+ * DESCRIPTION: Number of GOSSIP_DIGEST digests this node received
+ */
+long MP1Node::getDigestsReceived()
+{
+    return digestsReceived;
+}
+
+/**
+ * FUNCTION NAME: getDigestsMatched
+ *
+ * DESCRIPTION: Number of the digests this node received that matched its list
+ */
+long MP1Node::getDigestsMatched()
+{
+    return digestsMatched;
 }
 
-Address* MP1Node::constructAddress(char * address)
+/**
+ * FUNCTION NAME: getAddedIds
+ *
+ * DESCRIPTION: Ids this node added to its list; the caller clears it once read
+ */
+vector<int> &MP1Node::getAddedIds()
+{
+    return addedIds;
+}
+
+/**
+ * FUNCTION NAME: getRemovedIds
+ *
+ * DESCRIPTION: Ids this node removed from its list; the caller clears it once read
+ */
+vector<int> &MP1Node::getRemovedIds()
+{
+    return removedIds;
+}
+
+/**
+ * FUNCTION NAME: getActiveView
+ *
+ * DESCRIPTION: memberKeys of the HYPARVIEW active neighbours
+ */
+void MP1Node::getActiveView(vector<long> &keys)
+{
+    keys.clear();
+    for (unsigned int k = 0; k < activeView.size(); k++)
+    {
+        keys.push_back(activeView[k].key);
+    }
+}
+
+/**
+ * FUNCTION NAME: getPassiveSize
+ *
+ * DESCRIPTION: Members in the HYPARVIEW passive view
+ */
+int MP1Node::getPassiveSize()
 {
-    Address *pAddr =  new Address();
-    memcpy(pAddr->addr, address, sizeof(pAddr->addr));
-    return pAddr;
+    return passiveView.size();
+}
+
+/**
+ * FUNCTION NAME: isNullAddress
+ *
+ * DESCRIPTION: Function checks if the address is NULL
+ */
+int MP1Node::isNullAddress(Address *addr) {
+	return (memcmp(addr->addr, NULLADDR, 6) == 0 ? 1 : 0);
 }
 
-Address* MP1Node::constructAddress(int id, int port)
+/**
+ * FUNCTION NAME: getJoinAddress
+ *
+ * DESCRIPTION: Returns the Address of the coordinator
+ */
+Address MP1Node::getJoinAddress() {
+    Address joinaddr;
+
+    memset(&joinaddr, 0, sizeof(Address));
+    *(int *)(&joinaddr.addr) = 1;
+    *(short *)(&joinaddr.addr[4]) = 0;
+
+    return joinaddr;
+}
+
+/**
+ * FUNCTION NAME: initMemberListTable
+ *
+ * DESCRIPTION: Initialize the membership list
+ */
+void MP1Node::initMemberListTable(Member *memberNode) {
+	memberNode->memberList.clear();
+	memberNode->membershipEvents.clear();
+	memberIndex.clear();
+	peerState.clear();
+	suspects.clear();
+	deadMembers.clear();
+	phiState.clear();
+	swimGossip.clear();
+	deadlines.clear();
+	pullBuckets = 0;
+	probeTarget = -1;
+	activeView.clear();
+	passiveView.clear();
+	viewPending = -1;
+}
+
+/**
+ * FUNCTION NAME: printAddress
+ *
+ * DESCRIPTION: Print the Address
+ */
+void MP1Node::printAddress(Address *addr)
 {
-    Address *pAddr =  new Address();
-    memcpy(&pAddr->addr[0], &id, sizeof(int));
-    memcpy(&pAddr->addr[4], &port, sizeof(short));
-    return pAddr;
+    printf("%d.%d.%d.%d:%d \n",  addr->addr[0],addr->addr[1],addr->addr[2],
+                                                       addr->addr[3], *(short*)&addr->addr[4]) ;    
 }
@@ -14,12 +14,34 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "Codec.h"
+#include "TimerWheel.h"
+#include "Node.h"
+#include <unordered_map>
 
 /**
  * Macros
  */
 #define TREMOVE 20
 #define TFAIL 5
+// updates piggybacked on one SWIM message
+#define SWIM_PIGGYBACK 6
+// floor of the PHI detector's deviation estimate, in ticks. A history of equal intervals
+// would otherwise make any late heartbeat infinitely suspicious, and gossip delays have a
+// longer tail than a normal distribution; below 3 fanout gossip loses live members.
+#define PHI_MIN_STDDEV 3.0
+// members per bucket a GOSSIP_DIGEST digest aims for, and the most buckets it has;
+// a bucket mask of a DIGEST_PULL fits in two words
+#define DIGEST_BUCKET_SIZE 8
+#define DIGEST_MAX_BUCKETS 64
+// HYPARVIEW: hops of a join or shuffle walk, and the hop at which a join walk leaves the
+// joiner in the passive view; active and passive members a shuffle carries besides the
+// shuffler; keepalive periods an active neighbour may miss before it counts as failed
+#define VIEW_ARWL 6
+#define VIEW_PRWL 3
+#define VIEW_SHUFFLE_ACTIVE 3
+#define VIEW_SHUFFLE_PASSIVE 4
+#define VIEW_MISSED 3
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -32,6 +54,26 @@ enum MsgTypes{
     JOINREQ,
     JOINREP,
     PING,
+    // PING of GOSSIP_DELTA mode
+    DELTA,
+    // PING of GOSSIP_DIGEST mode: bucket hashes, and the buckets the receiver wants the entries of
+    DIGEST,
+    DIGEST_PULL,
+    // messages of the SWIM detector, SWIM frames with a SwimMessage and its updates
+    SWIM_PING,
+    SWIM_ACK,
+    SWIM_PINGREQ,
+    // heartbeat of the RING detector to a ring neighbour, with the SWIM updates piggybacked
+    RING_BEAT,
+    // HYPARVIEW membership, VIEW frames with a ViewMessage and its keys
+    VIEW_FORWARDJOIN,
+    VIEW_NEIGHBOR,
+    VIEW_NEIGHBOR_REPLY,
+    VIEW_DISCONNECT,
+    VIEW_SHUFFLE,
+    VIEW_SHUFFLE_REPLY,
+    // keepalive to a HYPARVIEW active neighbour, a SWIM frame with the updates of the ring's set
+    VIEW_KEEPALIVE,
     DUMMYLASTMSGTYPE
 };
 
@@ -44,13 +86,59 @@ typedef struct MessageHdr {
 	enum MsgTypes msgType;
 }MessageHdr;
 
-typedef struct MembershipInfo
+/**
+ * STRUCT NAME: PeerState
+ *
+ * DESCRIPTION: Ticks of the last gossip and of the last full list sent to one member
+ */
+typedef struct PeerState
+{
+	int lastSent;
+	int lastFull;
+}PeerState;
+
+/**
+ * STRUCT NAME: PhiState
+ *
+ * DESCRIPTION: Heartbeat arrival history of one member for the PHI detector: the tick of the
+ * 				last arrival and a ring of the last PHI_WINDOW inter-arrival times, with their
+ * 				running sum and sum of squares
+ */
+typedef struct PhiState
+{
+	int lastArrival;
+	int count;
+	int next;
+	double sum;
+	double sumSquares;
+	vector<int> intervals;
+	PhiState(): lastArrival(0), count(0), next(0), sum(0), sumSquares(0) {}
+}PhiState;
+
+enum SwimState { SWIM_ALIVE, SWIM_SUSPECT, SWIM_DEAD };
+
+/**
+ * STRUCT NAME: SwimGossip
+ *
+ * DESCRIPTION: An update waiting to be piggybacked, and how many more messages carry it
+ */
+typedef struct SwimGossip
+{
+	SwimUpdate update;
+	int sendsLeft;
+}SwimGossip;
+
+/**
+ * STRUCT NAME: ViewPeer
+ *
+ * DESCRIPTION: Member of a HYPARVIEW active view, with the ticks it was last heard from and last sent a keepalive
+ */
+typedef struct ViewPeer
 {
-	int id;
-	short port;
-	long heartbeat;
-	long timestamp;
-}MembershipInfo;
+	long key;
+	int heardAt;
+	int sentAt;
+}ViewPeer;
 
 /**
  * CLASS NAME: MP1Node
@@ -64,16 +152,119 @@ private:
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
+	// this node's own random stream, so that nodes running in parallel draw the same numbers as in a serial run
+	unsigned int rngState;
+	// slot of every member in memberNode->memberList, by memberKey
+	unordered_map<long, int> memberIndex;
+	// MP1 messages and bytes this node sent
+	long sentMessages;
+	long sentBytes;
+	// ids added to and removed from the list since the application last looked
+	vector<int> addedIds;
+	vector<int> removedIds;
+	// what delta gossip already sent to each member, by memberKey
+	unordered_map<long, PeerState> peerState;
+	// SWIM probe of this protocol period: target's memberKey (-1 if none), sequence, tick sent, whether acked
+	long probeTarget;
+	int probeSeq;
+	int probeSentAt;
+	bool probeAcked;
+	// tick each suspected member became suspect, by memberKey
+	unordered_map<long, int> suspects;
+	// incarnation (heartbeat with the PHI detector or GOSSIP_DIGEST) each removed member was declared dead with, by memberKey
+	unordered_map<long, long> deadMembers;
+	// PHI detector: arrival history of every member, by memberKey, and the standard
+	// deviations past the mean at which phi reaches PHI_THRESHOLD
+	unordered_map<long, PhiState> phiState;
+	double phiQuantile;
+	vector<SwimGossip> swimGossip;
+	// RING detector: memberKeys of the members this node watches, and the membershipVersion they were computed at
+	vector<long> ringNeighbours;
+	long ringVersion;
+	// HYPARVIEW: the active and passive views, and the passive member asked to become active (-1 if none) and when
+	vector<ViewPeer> activeView;
+	vector<long> passiveView;
+	long viewPending;
+	int viewPendingAt;
+	// scratch space of the per tick paths, reused so that a tick does not allocate
+	vector<WireEntry> sendEntries;
+	vector<WireEntry> recvEntries;
+	vector< vector<char> > sendFrameBuffers;
+	vector<char> swimBuffer;
+	vector<SwimUpdate> sendUpdates;
+	vector<SwimUpdate> recvUpdates;
+	vector<int> picks;
+	vector< pair<size_t, long> > ringOrder;
+	vector<long> ringNext;
+	vector<long> viewKeys;
+	vector<long> viewSample;
+	vector<char> viewBuffer;
+	vector<long> recvKeys;
+	vector<unsigned int> digestWords;
+	vector<unsigned int> recvWords;
+	vector<char> digestFrame;
+	// tick this node last exchanged each bucket, for digests of pullBuckets buckets
+	vector<int> pulledAt;
+	int pullBuckets;
+	// digests this node received, and how many of them matched its own list
+	long digestsReceived;
+	long digestsMatched;
+	// removal deadline of every member, heartbeat and PHI detectors; suspicion deadline of every neighbour, RING detector
+	TimerWheel deadlines;
+	vector<long> expiredKeys;
+	vector<int> expiredSlots;
+	// last tick whose heartbeat has been counted
+	int beatTime;
 
 private:
 	void addToMembershipList(char * newMemberAddress, long heartbeat, int timestamp);
 	void addToMembershipList(int id, int port, long heartbeat, int timestamp);
 	void sendSelfMembershipMessage(char * targetAddress, MsgTypes type);
 	bool isSameAddress(int id, short port);
-	void updateMembershipList(MessageHdr * data, int size);
-	bool isSameMemberInGroup(MemberListEntry *listEntry, MembershipInfo * reveivedMembershipInfo);
-	Address* constructAddress(char * address);
-	Address* constructAddress(int id, int port);
+	void mergeMembers(vector<WireEntry> &entries, long source);
+	void sendFrames(Address *to, MsgTypes type, vector<WireEntry> &entries);
+	static long memberKey(int id, short port);
+	int findMember(int id, short port);
+	void removeFailedMembers();
+	void beatUntil(int time);
+	void armDeadline(int slot);
+	void phiArrival(PhiState &state, int time);
+	int phiDeadline(PhiState &state);
+	static double phi(double mean, double deviation, double elapsed);
+	static double phiQuantileOf(double threshold);
+	void publish(int id, short port, bool joined);
+	void gossipToPeers();
+	void sendDelta(char * targetAddress);
+	void sendDigest(char * targetAddress);
+	void receiveDigest(int type, Address *sender, vector<unsigned int> &words);
+	void sendBuckets(Address *to, int buckets, unsigned long mask);
+	void digestOf(int buckets, vector<unsigned int> &hashes);
+	int digestBucket(int id, short port, int buckets);
+	static unsigned long mix(unsigned long value);
+	long selfKey();
+	static void keyAddress(long key, Address *addr);
+	void randomMembers(int count, long exclude1, long exclude2, vector<int> &slots);
+	void removeMember(int slot);
+	void swimTick();
+	void swimReceive(SwimMessage *msg, vector<SwimUpdate> &updates);
+	void swimApply(SwimUpdate *update);
+	void swimSuspect(int slot);
+	void swimEnqueue(int id, short port, int state, long incarnation);
+	void swimSend(char *to, MsgTypes type, int seq, char *origin, char *target, char *relay);
+	void swimExpireSuspects();
+	void ringTick();
+	void ringRefresh();
+	bool isRingNeighbour(long key);
+	void viewTick();
+	void viewReceive(ViewMessage *msg, vector<long> &keys);
+	void viewSend(long to, MsgTypes type, int ttl, int flag, long origin, vector<long> *keys);
+	void viewAddActive(long key);
+	void viewAddPassive(long key);
+	void viewRemovePassive(long key);
+	int viewFindActive(long key);
+	long viewRandomActive(long exclude1, long exclude2);
+	void viewSampleOf(vector<long> &keys, int count, vector<long> &out);
+	void viewHeard(long key);
 
 public:
 	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
@@ -90,10 +281,20 @@ public:
 	void checkMessages();
 	bool recvCallBack(void *env, char *data, int size);
 	void nodeLoopOps();
+	int nextTimer();
 	int isNullAddress(Address *addr);
 	Address getJoinAddress();
 	void initMemberListTable(Member *memberNode);
 	void printAddress(Address *addr);
+	bool knows(int id, short port);
+	long getSentMessages();
+	long getSentBytes();
+	long getDigestsReceived();
+	long getDigestsMatched();
+	vector<int> &getAddedIds();
+	vector<int> &getRemovedIds();
+	void getActiveView(vector<long> &keys);
+	int getPassiveSize();
 	virtual ~MP1Node();
 };
 
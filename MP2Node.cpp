@@ -15,6 +15,10 @@ MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log,
 	this->log = log;
 	ht = new HashTable();
 	this->memberNode->addr = *address;
+	this->quorumTimeouts = 0;
+	this->ringVersion = 0;
+	this->stabilizations = 0;
+	this->stabilizationMessages = 0;
 }
 
 /**
@@ -29,49 +33,20 @@ MP2Node::~MP2Node() {
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
- * 				2) Constructs the ring based on the membership list
+ * 				1) Takes the joins and leaves the Membership Protocol (MP1Node) published since
+ * 				   the last update, if the membership version moved at all
+ * 				2) Applies them to the ring, which stays sorted by hash code
  * 				3) Calls the Stabilization Protocol
  */
 void MP2Node::updateRing() {
-	/*
-	 * Implement this. Parts of it are already implemented
-	 */
-
-	vector<Node> curMemList;
 	bool change = false;
 
 	/*
-	 *  Step 1. Get the current membership list from Membership Protocol / MP1
-	 */
-	curMemList = getMembershipList();
-
-	/*
-	 * Step 2: Construct the ring
+	 *  Step 1 and 2. Apply the membership changes to the ring
 	 */
-	//Sort the list based on the hashCode
-	sort(curMemList.begin(), curMemList.end());
-
-	if(ring.size() != curMemList.size())
-	{
-		change = true;
-	}
-	else
-	{
-		for(int i = 0; i < curMemList.size(); i++)
-		{
-			if(!isSameNode(curMemList[i], ring[i]))
-			{
-				change = true;
-				break;
-			}		
-		}	
-	}
-		
-	if(change)
+	if(this->memberNode->membershipVersion != ringVersion)
 	{
-		ring = curMemList;
+		change = applyMembershipEvents();
 	}
  
 	if(this->hasMyReplicas.size() == 0 && ring.size() > 0)
@@ -105,6 +80,17 @@ void MP2Node::updateRing() {
 	 }
 }
 
+/**
+ * FUNCTION NAME: ringCurrent
+ *
+ * DESCRIPTION: True when updateRing has nothing to do: no membership change since the ring was
+ * 				built, and the replica lists are filled in if the ring has any node
+ */
+bool MP2Node::ringCurrent() {
+	return this->memberNode->membershipVersion == ringVersion &&
+			(ring.size() == 0 || (this->hasMyReplicas.size() > 0 && this->haveReplicasOf.size() > 0));
+}
+
 int MP2Node::getCurrentNodePosInRing()
 {
 	int currentIndex = -1;
@@ -121,27 +107,46 @@ int MP2Node::getCurrentNodePosInRing()
 }
 
 /**
- * FUNCTION NAME: getMemberhipList
+ * FUNCTION NAME: applyMembershipEvents
+ *
+ * DESCRIPTION: Inserts the members that joined into the ring and erases the ones that left, in
+ * 				the order MP1 published them. A joining node goes after the nodes of equal hash
+ * 				code already there, the order a stable sort of the membership list gives.
  *
- * DESCRIPTION: This function goes through the membership list from the Membership protocol/MP1 and
- * 				i) generates the hash code for each member
- * 				ii) populates the ring member in MP2Node class
- * 				It returns a vector of Nodes. Each element in the vector contain the following fields:
- * 				a) Address of the node
- * 				b) Hash code obtained by consistent hashing of the Address
+ * RETURNS:
+ * whether the ring changed
  */
-vector<Node> MP2Node::getMembershipList() {
-	unsigned int i;
-	vector<Node> curMemList;
-	for ( i = 0 ; i < this->memberNode->memberList.size(); i++ ) {
-		Address addressOfThisMember;
-		int id = this->memberNode->memberList.at(i).getid();
-		short port = this->memberNode->memberList.at(i).getport();
-		memcpy(&addressOfThisMember.addr[0], &id, sizeof(int));
-		memcpy(&addressOfThisMember.addr[4], &port, sizeof(short));
-		curMemList.emplace_back(Node(addressOfThisMember));
+bool MP2Node::applyMembershipEvents() {
+	vector<MembershipEvent> &events = this->memberNode->membershipEvents;
+	bool change = false;
+
+	for ( unsigned int i = 0; i < events.size(); i++ ) {
+		Address address;
+		memcpy(&address.addr[0], &events[i].id, sizeof(int));
+		memcpy(&address.addr[4], &events[i].port, sizeof(short));
+		Node node(address);
+
+		vector<Node>::iterator it = lower_bound(ring.begin(), ring.end(), node);
+		vector<Node>::iterator end = upper_bound(it, ring.end(), node);
+		while ( it != end && !(*it->getAddress() == address) ) {
+			it++;
+		}
+
+		if ( events[i].joined && it == end ) {
+			ringTokens.insert(ringTokens.begin() + (end - ring.begin()), node.getHashCode());
+			ring.insert(end, node);
+			change = true;
+		}
+		else if ( !events[i].joined && it != end ) {
+			ringTokens.erase(ringTokens.begin() + (it - ring.begin()));
+			ring.erase(it);
+			change = true;
+		}
 	}
-	return curMemList;
+
+	events.clear();
+	ringVersion = this->memberNode->membershipVersion;
+	return change;
 }
 
 /**
@@ -153,7 +158,7 @@ vector<Node> MP2Node::getMembershipList() {
  * RETURNS:
  * size_t position on the ring
  */
-size_t MP2Node::hashFunction(string key) {
+size_t MP2Node::hashFunction(const string &key) {
 	std::hash<string> hashFunc;
 	size_t ret = hashFunc(key);
 	return ret%RING_SIZE;
@@ -171,16 +176,17 @@ size_t MP2Node::hashFunction(string key) {
 void MP2Node::clientCreate(string key, string value) {
 	
 	 // Get all the replica Node
-	vector<Node> replicaNodes = findNodes(key);
+	int replicas[REPLICA_COUNT];
+	int replicaCount = findReplicas(hashFunction(key), replicas);
 	int transID = g_transID++;
 
-	for(int i = 0; i < replicaNodes.size(); i++)
+	for(int i = 0; i < replicaCount; i++)
 	{
 		ReplicaType replica = static_cast<ReplicaType>(i);
 		Message* pMessage = new Message(transID, 
 			this->memberNode->addr, CREATE, key, value,replica);
 
-		this->emulNet->ENsend(&memberNode->addr, replicaNodes[i].getAddress(), pMessage->toString());
+		sendMessage(ring[replicas[i]].getAddress(), pMessage);
 		delete(pMessage);
 	}
 
@@ -204,15 +210,16 @@ void MP2Node::clientCreate(string key, string value) {
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientRead(string key){
-	vector<Node> replicaNodes = findNodes(key);
+	int replicas[REPLICA_COUNT];
+	int replicaCount = findReplicas(hashFunction(key), replicas);
 	int transID = g_transID++;
 
-	for(int i = 0; i < replicaNodes.size(); i++)
+	for(int i = 0; i < replicaCount; i++)
 	{
 		Message* pMessage = new Message(transID, 
 			this->memberNode->addr, READ, key);
 
-		this->emulNet->ENsend(&memberNode->addr, replicaNodes[i].getAddress(), pMessage->toString());
+		sendMessage(ring[replicas[i]].getAddress(), pMessage);
 		delete(pMessage);
 	}
 
@@ -236,16 +243,17 @@ void MP2Node::clientRead(string key){
  */
 void MP2Node::clientUpdate(string key, string value){
 
-	vector<Node> replicaNodes = findNodes(key);
+	int replicas[REPLICA_COUNT];
+	int replicaCount = findReplicas(hashFunction(key), replicas);
 	int transID = g_transID++;
 
-	for(int i = 0; i < replicaNodes.size(); i++)
+	for(int i = 0; i < replicaCount; i++)
 	{
 		ReplicaType replica = static_cast<ReplicaType>(i);
 		Message* pMessage = new Message(transID, 
 			this->memberNode->addr, UPDATE, key, value, replica);
 
-		this->emulNet->ENsend(&memberNode->addr, replicaNodes[i].getAddress(), pMessage->toString());
+		sendMessage(ring[replicas[i]].getAddress(), pMessage);
 		delete(pMessage);
 	}
 
@@ -269,15 +277,16 @@ void MP2Node::clientUpdate(string key, string value){
  * 				3) Sends a message to the replica
  */
 void MP2Node::clientDelete(string key){
-	vector<Node> replicaNodes = findNodes(key);
+	int replicas[REPLICA_COUNT];
+	int replicaCount = findReplicas(hashFunction(key), replicas);
 	int transID = g_transID++;
 
-	for(int i = 0; i < replicaNodes.size(); i++)
+	for(int i = 0; i < replicaCount; i++)
 	{
 		Message* pMessage = new Message(transID, 
 			this->memberNode->addr, DELETE, key);
 
-		this->emulNet->ENsend(&memberNode->addr, replicaNodes[i].getAddress(), pMessage->toString());
+		sendMessage(ring[replicas[i]].getAddress(), pMessage);
 		delete(pMessage);
 	}
 
@@ -298,13 +307,10 @@ void MP2Node::clientDelete(string key){
  * 			   	1) Inserts key value into the local hash table
  * 			   	2) Return true or false based on success or failure
  */
-bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
+bool MP2Node::createKeyValue(const string &key, const string &value, ReplicaType replica) {
 
 	// Insert key, value, replicaType into the hash table
-	Entry * entry = new Entry(value, par->globaltime,replica);
-	bool isSuccess = ht->create(key, entry->convertToString());
-	delete(entry);
-	return isSuccess;
+	return ht->create(key, Entry(value, par->globaltime, replica));
 }
 
 /**
@@ -315,9 +321,10 @@ bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
  * 			    1) Read key from local hash table
  * 			    2) Return value
  */
-string MP2Node::readKey(string key) {
+string MP2Node::readKey(const string &key) {
 	// Read key from local hash table and return value
-	return ht->read(key);
+	const Entry *entry = ht->read(key);
+	return entry ? entry->value : "";
 }
 
 /**
@@ -328,13 +335,10 @@ string MP2Node::readKey(string key) {
  * 				1) Update the key to the new value in the local hash table
  * 				2) Return true or false based on success or failure
  */
-bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
+bool MP2Node::updateKeyValue(const string &key, const string &value, ReplicaType replica) {
 	
 	// Update key in local hash table and return true or false
-	Entry * entry = new Entry(value, par->globaltime,replica);
-	bool isSuccess = ht->update(key, entry->convertToString());
-	delete(entry);
-	return isSuccess;
+	return ht->update(key, Entry(value, par->globaltime, replica));
 }
 
 /**
@@ -345,150 +349,142 @@ bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
  * 				1) Delete the key from the local hash table
  * 				2) Return true or false based on success or failure
  */
-bool MP2Node::deletekey(string key) {
+bool MP2Node::deletekey(const string &key) {
 	
 	// Delete the key from the local hash table
 	return ht->deleteKey(key);
 }
 
-void MP2Node::doCreateReplyMessage(Message* receivedMessage)
+void MP2Node::doCreateReplyMessage(MessageView &receivedMessage)
 {
-	bool isCreateSucc = createKeyValue(receivedMessage->key,
-	receivedMessage->value, receivedMessage->replica);
+	recvKey.assign(receivedMessage.key, receivedMessage.keySize);
+	recvValue.assign(receivedMessage.value, receivedMessage.valueSize);
+	bool isCreateSucc = createKeyValue(recvKey, recvValue, receivedMessage.replica);
 	//Create reply Message format : 
 	//			Message(int _transID, Address _fromAddr, MessageType _type, bool _success)
-	if(receivedMessage->transID != -1)
+	if(receivedMessage.transID != -1)
 	{
-		Message* replyMessage = new Message(receivedMessage->transID, 
+		Message replyMessage(receivedMessage.transID, 
 			this->memberNode->addr, REPLY, isCreateSucc);
 
-		this->emulNet->ENsend(&memberNode->addr, &receivedMessage->fromAddr, replyMessage->toString());
-
-		delete(replyMessage);
+		sendMessage(&receivedMessage.fromAddr, &replyMessage);
 
 		if(isCreateSucc)
 		{
-			log->logCreateSuccess(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key, receivedMessage->value);
+			log->logCreateSuccess(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey, recvValue);
 
 		}
 		else
 		{
-			log->logCreateFail(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key, receivedMessage->value);
+			log->logCreateFail(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey, recvValue);
 		}
 	}
 }
 
-void MP2Node::doDeleteReplyMessage(Message* receivedMessage)
+void MP2Node::doDeleteReplyMessage(MessageView &receivedMessage)
 {
-	bool isDeleteSucc = deletekey(receivedMessage->key);
+	recvKey.assign(receivedMessage.key, receivedMessage.keySize);
+	bool isDeleteSucc = deletekey(recvKey);
 
-	if(receivedMessage->transID != -1)
+	if(receivedMessage.transID != -1)
 	{
-		Message* replyMessage = new Message(receivedMessage->transID, 
+		Message replyMessage(receivedMessage.transID, 
 		this->memberNode->addr, REPLY, isDeleteSucc);
 
-		this->emulNet->ENsend(&memberNode->addr, &receivedMessage->fromAddr, replyMessage->toString());
+		sendMessage(&receivedMessage.fromAddr, &replyMessage);
 
-		delete(replyMessage);	
 		if(isDeleteSucc)
 		{
-			log->logDeleteSuccess(&this->memberNode->addr, false, receivedMessage->transID,
-			receivedMessage->key);
+			log->logDeleteSuccess(&this->memberNode->addr, false, receivedMessage.transID,
+			recvKey);
 
 		}
 		else
 		{
-			log->logDeleteFail(&this->memberNode->addr, false, receivedMessage->transID,
-			receivedMessage->key);
+			log->logDeleteFail(&this->memberNode->addr, false, receivedMessage.transID,
+			recvKey);
 		}	 
 	}
 }
 
-void MP2Node::doUpdateReplyMessage(Message * receivedMessage)
+void MP2Node::doUpdateReplyMessage(MessageView &receivedMessage)
 {
-	bool isUpdateSucc = updateKeyValue(receivedMessage->key,
-	receivedMessage->value, receivedMessage->replica);
-	if(receivedMessage->transID != -1)
+	recvKey.assign(receivedMessage.key, receivedMessage.keySize);
+	recvValue.assign(receivedMessage.value, receivedMessage.valueSize);
+	bool isUpdateSucc = updateKeyValue(recvKey, recvValue, receivedMessage.replica);
+	if(receivedMessage.transID != -1)
 	{
-		Message* replyMessage = new Message(receivedMessage->transID, 
+		Message replyMessage(receivedMessage.transID, 
 			this->memberNode->addr, REPLY, isUpdateSucc);
 
-		this->emulNet->ENsend(&memberNode->addr, &receivedMessage->fromAddr, replyMessage->toString());
-
-		delete(replyMessage);
+		sendMessage(&receivedMessage.fromAddr, &replyMessage);
 
 		if(isUpdateSucc)
 		{
-			log->logUpdateSuccess(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key, receivedMessage->value);
+			log->logUpdateSuccess(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey, recvValue);
 
 		}
 		else
 		{
-			log->logUpdateFail(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key, receivedMessage->value);
+			log->logUpdateFail(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey, recvValue);
 		}
 	}
 }
 
-void MP2Node::doReadReplyMessage(Message * receivedMessage)
+void MP2Node::doReadReplyMessage(MessageView &receivedMessage)
 {
-	string readValue = readKey(receivedMessage->key);
-	if(readValue != "")
-	{
-		Entry * entry = new Entry(readValue);
-		readValue = entry->value;
-		delete entry;
-	}	
+	recvKey.assign(receivedMessage.key, receivedMessage.keySize);
+	string readValue = readKey(recvKey);
 
-	if(receivedMessage->transID != -1)
+	if(receivedMessage.transID != -1)
 	{
-		Message* replyMessage = new Message(receivedMessage->transID, 
+		Message replyMessage(receivedMessage.transID, 
 			this->memberNode->addr, readValue);
 
-		this->emulNet->ENsend(&memberNode->addr, &receivedMessage->fromAddr, replyMessage->toString());
+		sendMessage(&receivedMessage.fromAddr, &replyMessage);
 
-		delete(replyMessage);	
 		if(readValue != "")
 		{
-			log->logReadSuccess(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key, readValue);
+			log->logReadSuccess(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey, readValue);
 
 		}
 		else
 		{
-			log->logReadFail(&this->memberNode->addr, false, receivedMessage->transID,
-				receivedMessage->key);
+			log->logReadFail(&this->memberNode->addr, false, receivedMessage.transID,
+				recvKey);
 		}	 
 	}
 }
 
-void MP2Node::doReadReplyReplyMessage(Message * receivedMessage)
+void MP2Node::doReadReplyReplyMessage(MessageView &receivedMessage)
 {
-	if(receivedMessage->value != "")
+	if(receivedMessage.valueSize > 0)
 	{
 		map<int, TransInfo>::iterator search;
-		search = transIdInfo.find(receivedMessage->transID);
+		search = transIdInfo.find(receivedMessage.transID);
 		if ( search != transIdInfo.end() ) 
 		{
 			//TODD : how to solve the read conflict
-			transIdInfo[receivedMessage->transID].value = receivedMessage->value;
-			transIdInfo[receivedMessage->transID].replyTimes ++ ;
+			search->second.value.assign(receivedMessage.value, receivedMessage.valueSize);
+			search->second.replyTimes ++ ;
 		}
 	}	
 }
 
-void MP2Node::doReplyReplyMessage(Message* receivedMessage)
+void MP2Node::doReplyReplyMessage(MessageView &receivedMessage)
 {
-	if(receivedMessage->success)
+	if(receivedMessage.success)
 	{
 		map<int, TransInfo>::iterator search;
-		search = transIdInfo.find(receivedMessage->transID);
+		search = transIdInfo.find(receivedMessage.transID);
 		if ( search != transIdInfo.end() ) 
 		{
-			transIdInfo[receivedMessage->transID].replyTimes ++ ;
+			search->second.replyTimes ++ ;
 		}
 	}		 		
 }
@@ -497,6 +493,7 @@ void MP2Node::checkCoordinatorCreateMessage(int transID,TransInfo transInfo)
 {
 	if(par->globaltime - transInfo.startTime > TIME_OUT)
 	{
+		quorumTimeouts++;
 		log->logCreateFail(&this->memberNode->addr,
 			true,
 		    transID, 
@@ -507,6 +504,7 @@ void MP2Node::checkCoordinatorCreateMessage(int transID,TransInfo transInfo)
 	{
 		if(transInfo.replyTimes >= 2)
 		{
+			quorumLatency.push_back(par->globaltime - transInfo.startTime);
 			log->logCreateSuccess(&this->memberNode->addr,
 				true, 
 				transID,
@@ -520,6 +518,7 @@ void MP2Node::checkCoordinatorDeleteMessage(int transID, TransInfo transInfo)
 {
 	if(par->globaltime - transInfo.startTime > TIME_OUT)
 	{
+		quorumTimeouts++;
 		log->logDeleteFail(&this->memberNode->addr,
 			true,
 		    transID, 
@@ -530,6 +529,7 @@ void MP2Node::checkCoordinatorDeleteMessage(int transID, TransInfo transInfo)
 	{
 		if(transInfo.replyTimes >= 2)
 		{
+			quorumLatency.push_back(par->globaltime - transInfo.startTime);
 			log->logDeleteSuccess(&this->memberNode->addr,
 				true, 
 				transID,
@@ -543,6 +543,7 @@ void MP2Node::checkCoordinatorUpdateMessage(int transID, TransInfo transInfo)
 {
 	if(par->globaltime - transInfo.startTime > TIME_OUT)
 	{
+		quorumTimeouts++;
 		log->logUpdateFail(&this->memberNode->addr,
 			true,
 		    transID, 
@@ -554,6 +555,7 @@ void MP2Node::checkCoordinatorUpdateMessage(int transID, TransInfo transInfo)
 	{
 		if(transInfo.replyTimes >= 2)
 		{
+			quorumLatency.push_back(par->globaltime - transInfo.startTime);
 			log->logUpdateSuccess(&this->memberNode->addr,
 				true, 
 				transID,
@@ -569,6 +571,7 @@ void MP2Node::checkCoordinatorReadMessage(int transID, TransInfo transInfo)
 {
 	if(par->globaltime -  transInfo.startTime > TIME_OUT)
 	{
+		quorumTimeouts++;
 		log->logReadFail(&this->memberNode->addr,
 			true,
 		    transID, 
@@ -579,6 +582,7 @@ void MP2Node::checkCoordinatorReadMessage(int transID, TransInfo transInfo)
 	{
 		if(transInfo.replyTimes >= 2)
 		{
+			quorumLatency.push_back(par->globaltime - transInfo.startTime);
 			log->logReadSuccess(&this->memberNode->addr,
 				true, 
 				transID,
@@ -593,36 +597,58 @@ void MP2Node::checkCoordinatoReplyStatus()
 {
 	// checkCoordinator reply status
 	// TODO: support rollback. Now we seem all the operation from client as a transcation
-	map<int, TransInfo>::iterator it;
-	for(it = this->transIdInfo.begin(); it != this->transIdInfo.end(); it++)
+	// the check functions erase finished transactions, so step the iterator first
+	map<int, TransInfo>::iterator it = this->transIdInfo.begin();
+	while(it != this->transIdInfo.end())
 	{
+		int transID = it->first;
 		TransInfo transInfo = it->second;
+		it++;
 		switch(transInfo.type)
 		{
 			case CREATE:
 			{	
-				checkCoordinatorCreateMessage(it->first, transInfo);
+				checkCoordinatorCreateMessage(transID, transInfo);
 				break;
 			}
 			case DELETE:
 			{
-				checkCoordinatorDeleteMessage(it->first,transInfo);
+				checkCoordinatorDeleteMessage(transID, transInfo);
 				break;
 			}
 			case UPDATE:
 			{
-				checkCoordinatorUpdateMessage(it->first,transInfo);	
+				checkCoordinatorUpdateMessage(transID, transInfo);	
 				break;
 			}
 			case READ:
 			{
-				checkCoordinatorReadMessage(it->first,transInfo);		
+				checkCoordinatorReadMessage(transID, transInfo);		
 				break;	
 			}
 		}
 	}		
 }
 
+/**
+ * FUNCTION NAME: sendMessage
+ *
+ * DESCRIPTION: Sends a message in the format MP2_WIRE asks for. Binary messages are encoded
+ * 				into a buffer the node keeps from one send to the next.
+ */
+void MP2Node::sendMessage(Address *toAddress, Message *message) {
+	if ( par->MP2_WIRE == TEXT_WIRE ) {
+		this->emulNet->ENsend(&memberNode->addr, toAddress, message->toString());
+		return;
+	}
+	int size = message->encodedSize();
+	if ( (int)sendBuffer.size() < size ) {
+		sendBuffer.resize(size);
+	}
+	message->encode(&sendBuffer[0], sendBuffer.size());
+	this->emulNet->ENsend(&memberNode->addr, toAddress, &sendBuffer[0], size);
+}
+
 /**
  * FUNCTION NAME: checkMessages
  *
@@ -652,10 +678,22 @@ void MP2Node::checkMessages() {
 
 		memberNode->mp2q.pop();
 
-		string message(data, data + size);
-		Message* receivedMessage = new Message(message);
+		// A binary message is handled in place; a text one is parsed first and handled through a view of it
+		MessageView receivedMessage;
+		Message *textMessage = NULL;
+		if ( Message::isBinary(data, size) ) {
+			if ( !Message::decode(data, size, receivedMessage) ) {
+				// malformed or of an unknown version, the text parser would only choke on it
+				EmulNet::ENrelease(data);
+				continue;
+			}
+		}
+		else {
+			textMessage = new Message(string(data, data + size));
+			textMessage->toView(receivedMessage);
+		}
 		
-		 switch(receivedMessage->type)
+		 switch(receivedMessage.type)
 		 {
 		 	case CREATE:
 		 	{
@@ -689,13 +727,50 @@ void MP2Node::checkMessages() {
 		 	}
 		 }
 
-		 delete(receivedMessage); 
+		 // the view points into data until here
+		 delete(textMessage);
+		 EmulNet::ENrelease(data);
 	}
 
 	// checkCoordinator reply status
 	checkCoordinatoReplyStatus();
 }
 
+/**
+ * FUNCTION NAME: findReplicas
+ *
+ * DESCRIPTION: Ring positions of the replicas of a key at position pos: the first node whose
+ * 				hash code is at least pos, or the first node of the ring when pos is past the
+ * 				last one, and the two nodes after it. The search halves the token array with a
+ * 				conditional add instead of a branch, so it takes the same log2 steps for every
+ * 				key and the loads do not wait on mispredicted jumps.
+ *
+ * RETURNS:
+ * the number of replicas, REPLICA_COUNT, or 0 if the ring has fewer nodes
+ */
+int MP2Node::findReplicas(size_t pos, int *replicas) {
+	size_t count = ringTokens.size();
+
+	if ( count < REPLICA_COUNT ) {
+		return 0;
+	}
+	const size_t *base = &ringTokens[0];
+	size_t n = count;
+	while ( n > 1 ) {
+		size_t half = n / 2;
+		base += (base[half - 1] < pos) * half;
+		n -= half;
+	}
+	size_t first = (base - &ringTokens[0]) + (*base < pos);
+	if ( first == count ) {
+		first = 0;
+	}
+	for ( int i = 0; i < REPLICA_COUNT; i++ ) {
+		replicas[i] = (first + i) % count;
+	}
+	return REPLICA_COUNT;
+}
+
 /**
  * FUNCTION NAME: findNodes
  *
@@ -703,27 +778,11 @@ void MP2Node::checkMessages() {
  * 				This function is responsible for finding the replicas of a key
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
+	int replicas[REPLICA_COUNT];
+	int replicaCount = findReplicas(hashFunction(key), replicas);
 	vector<Node> addr_vec;
-	if (ring.size() >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i<ring.size(); i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
-					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
-					break;
-				}
-			}
-		}
+	for (int i = 0; i < replicaCount; i++) {
+		addr_vec.emplace_back(ring[replicas[i]]);
 	}
 	return addr_vec;
 }
@@ -761,7 +820,7 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
  */
 void MP2Node::stabilizationProtocol() {
-	
+	stabilizations++;
 
 	// First :	update the second and third node who has my replicas
 
@@ -770,7 +829,6 @@ void MP2Node::stabilizationProtocol() {
 	int thirdRepPos = (currentIndex + 2) % ring.size();
 	Node secondRepPosNode = this->hasMyReplicas[0];
 	Node thirdRepPosNode = this->hasMyReplicas[1];
-	map<string,string> primaryItemsInHashTable = getKeysOfThisNode(PRIMARY);
 
 	if(! isSameNode(secondRepPosNode, ring[secondRepPos]))
 	{		
@@ -779,11 +837,11 @@ void MP2Node::stabilizationProtocol() {
 		// we need send create message to this node
 		if(! isSameNode(thirdRepPosNode, ring[secondRepPos]))
 		{
-			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY, CREATE, primaryItemsInHashTable);
+			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY, CREATE, PRIMARY);
 		}
 		else
 		{
-			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY,UPDATE, primaryItemsInHashTable);
+			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY,UPDATE, PRIMARY);
 		}
 		
 	}
@@ -796,11 +854,11 @@ void MP2Node::stabilizationProtocol() {
 		
 		if(! isSameNode(secondRepPosNode, ring[thirdRepPos]))
 		{
-			updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY, CREATE, primaryItemsInHashTable);
+			updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY, CREATE, PRIMARY);
 		}
 		else
 		{
-			updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY,UPDATE, primaryItemsInHashTable);
+			updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY,UPDATE, PRIMARY);
 		}
 	}
 
@@ -816,9 +874,9 @@ void MP2Node::stabilizationProtocol() {
 		if(! isSameNode(thirdHaveRepNode, ring[secondHaveRepPos]))
 		{
 			isSecondHaveNodeLost = true;
-			map<string,string> secondaryInHashTable = getKeysOfThisNode(SECONDARY);
-			updateBossedReplicaLocally(secondaryInHashTable, PRIMARY);
-			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY, CREATE, secondaryInHashTable);
+			// hand the keys I held for the lost node on, then hold them as primary
+			updateMyReplica(ring[secondRepPos].getAddress(), SECONDARY, CREATE, SECONDARY);
+			updateBossedReplicaLocally(SECONDARY, PRIMARY);
 			
 		}
 	}
@@ -829,9 +887,8 @@ void MP2Node::stabilizationProtocol() {
 		{
 			if(!isSameNode(secondRepPosNode, ring[thirdHaveRepPos]))
 			{
-			 	map<string,string> tertiaryInHashTable = getKeysOfThisNode(TERTIARY);
-			 	updateBossedReplicaLocally(tertiaryInHashTable, PRIMARY);
-			 	updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY, CREATE, tertiaryInHashTable);
+			 	updateMyReplica(ring[thirdRepPos].getAddress(), TERTIARY, CREATE, TERTIARY);
+			 	updateBossedReplicaLocally(TERTIARY, PRIMARY);
 			}
 		}
 	}
@@ -851,55 +908,28 @@ void MP2Node::stabilizationProtocol() {
 	this->haveReplicasOf = newPossedReplica;
 }
 
-void MP2Node::updateBossedReplicaLocally(map<string, string> items, ReplicaType replicaType)
+void MP2Node::updateBossedReplicaLocally(ReplicaType from, ReplicaType to)
 {
-	for(map<string, string>::iterator it = items.begin(); it != items.end(); it++)
-	{
-		Entry * entry = new Entry(it->second);
-		entry->replica = replicaType;
-		string newValue = entry->convertToString();
-		ht->update(it->first, newValue);
-
-		delete entry;
-	}
+	ht->moveReplicas(from, to);
 }
 
-void MP2Node::updateMyReplica(Address* toAddress, ReplicaType replicaType, MessageType messageType, map<string, string> items)
+void MP2Node::updateMyReplica(Address* toAddress, ReplicaType replicaType, MessageType messageType, ReplicaType held)
 {	
 	// cout << memberNode->addr.getAddress() << "  send message to  " <<toAddress->getAddress() << " at " << par->globaltime << endl;
 	// transID::fromAddr::CREATE::key::value::ReplicaType
 	
-	for(map<string, string>::iterator it = items.begin(); it != items.end(); it++)
+	this->ht->forEachOf(held, [&](const string &key, const Entry &entry)
 	{
-		Message* pMessage = new Message(-1 , this->memberNode->addr, messageType, it->first, it->second,replicaType);
+		Message* pMessage = new Message(-1 , this->memberNode->addr, messageType, key, entry.value,replicaType);
 		// cout << pMessage->toString() << endl;
 
-		this->emulNet->ENsend(&memberNode->addr, toAddress, pMessage->toString());
+		sendMessage(toAddress, pMessage);
+		stabilizationMessages++;
 		delete(pMessage);
-	}
+	});
 }
 
 bool MP2Node::isSameNode(Node one, Node another)
 {
 	return (*one.getAddress() == *another.getAddress());
-}
-
-map<string, string> MP2Node::getKeysOfThisNode(ReplicaType replica)
-{
-	map<string, string> primaryItems;
-
-	map<string, string>::iterator it;
-	for(it = this->ht->hashTable.begin(); it != this->ht->hashTable.end(); it++)
-	{
-		string value = it->second;
-		Entry * entry = new Entry(value);
-		if(entry->replica == replica)
-		{
-			primaryItems.emplace(it->first,it->second);
-		}
-
-		delete entry;
-	}
-
-	return primaryItems;
 }
\ No newline at end of file
@@ -20,6 +20,8 @@
 #include "Queue.h"
 
 #define TIME_OUT 20
+// nodes holding each key
+#define REPLICA_COUNT 3
 
 /**
  * CLASS NAME: MP2Node
@@ -49,6 +51,10 @@ private:
 	vector<Node> haveReplicasOf;
 	// Ring
 	vector<Node> ring;
+	// hash code of every node of the ring, in ring order, for the lookups to search
+	vector<size_t> ringTokens;
+	// membership version the ring is up to date with
+	long ringVersion;
 	// Hash Table
 	HashTable * ht;
 	// Member representing this member
@@ -61,24 +67,37 @@ private:
 	Log * log;
 
 	map<int, TransInfo> transIdInfo;
+	// ticks from request to quorum of every transaction this node coordinated
+	vector<int> quorumLatency;
+	// transactions this node coordinated that timed out
+	int quorumTimeouts;
+	// ring changes that ran the stabilization protocol, and the replica messages they sent
+	int stabilizations;
+	long stabilizationMessages;
+	// encoding buffer of the binary messages this node sends
+	vector<char> sendBuffer;
+	// key and value of the message being handled, copied out of its view into strings that
+	// keep their capacity from one message to the next
+	string recvKey;
+	string recvValue;
 
 private:
 	int getCurrentNodePosInRing();
-	void updateBossedReplicaLocally(map<string, string> items, ReplicaType replicaType);
-	map<string, string> getKeysOfThisNode(ReplicaType replica);
+	void updateBossedReplicaLocally(ReplicaType from, ReplicaType to);
 	bool isSameNode(Node one, Node another);
 	void updateMyReplica(
 		Address* toAddress,
 		ReplicaType replicaType,
 	 	MessageType messageType, 
-	 	map<string, string> items);
+	 	ReplicaType held);
 
-	void doCreateReplyMessage(Message* receivedMessage);
-	void doDeleteReplyMessage(Message* receivedMessage);
-	void doReadReplyMessage(Message* receivedMessage);
-	void doUpdateReplyMessage(Message* receivedMessage);
-	void doReadReplyReplyMessage(Message* receivedMessage);
-	void doReplyReplyMessage(Message* receivedMessage);
+	void sendMessage(Address *toAddress, Message *message);
+	void doCreateReplyMessage(MessageView &receivedMessage);
+	void doDeleteReplyMessage(MessageView &receivedMessage);
+	void doReadReplyMessage(MessageView &receivedMessage);
+	void doUpdateReplyMessage(MessageView &receivedMessage);
+	void doReadReplyReplyMessage(MessageView &receivedMessage);
+	void doReplyReplyMessage(MessageView &receivedMessage);
 
 	void checkCoordinatoReplyStatus();
 
@@ -92,11 +111,25 @@ public:
 	Member * getMemberNode() {
 		return this->memberNode;
 	}
+	vector<int> & getQuorumLatencies() {
+		return this->quorumLatency;
+	}
+	int getQuorumTimeouts() {
+		return this->quorumTimeouts;
+	}
+	int getStabilizations() {
+		return this->stabilizations;
+	}
+	long getStabilizationMessages() {
+		return this->stabilizationMessages;
+	}
 
 	// ring functionalities
 	void updateRing();
-	vector<Node> getMembershipList();
-	size_t hashFunction(string key);
+	bool ringCurrent();
+	bool applyMembershipEvents();
+	size_t hashFunction(const string &key);
+	int findReplicas(size_t pos, int *replicas);
 	void findNeighbors();
 
 	// client side CRUD APIs
@@ -119,10 +152,10 @@ public:
 	vector<Node> findNodes(string key);
 
 	// server
-	bool createKeyValue(string key, string value, ReplicaType replica);
-	string readKey(string key);
-	bool updateKeyValue(string key, string value, ReplicaType replica);
-	bool deletekey(string key);
+	bool createKeyValue(const string &key, const string &value, ReplicaType replica);
+	string readKey(const string &key);
+	bool updateKeyValue(const string &key, const string &value, ReplicaType replica);
+	bool deletekey(const string &key);
 
 	// stabilization protocol - handle multiple failures
 	void stabilizationProtocol();
@@ -38,12 +38,12 @@ bool Address::operator ==(const Address& anotherAddress) {
 /**
  * Constructor
  */
-MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp) {}
+MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp), changedAt(0), changedFrom(-1) {}
 
 /**
  * Constuctor
  */
-MemberListEntry::MemberListEntry(int id, short port): id(id), port(port) {}
+MemberListEntry::MemberListEntry(int id, short port): id(id), port(port), changedAt(0), changedFrom(-1) {}
 
 /**
  * Copy constructor
@@ -53,6 +53,8 @@ MemberListEntry::MemberListEntry(const MemberListEntry &anotherMLE) {
 	this->id = anotherMLE.id;
 	this->port = anotherMLE.port;
 	this->timestamp = anotherMLE.timestamp;
+	this->changedAt = anotherMLE.changedAt;
+	this->changedFrom = anotherMLE.changedFrom;
 }
 
 /**
@@ -64,6 +66,8 @@ MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE)
 	swap(id, temp.id);
 	swap(port, temp.port);
 	swap(timestamp, temp.timestamp);
+	swap(changedAt, temp.changedAt);
+	swap(changedFrom, temp.changedFrom);
 	return *this;
 }
 
@@ -152,6 +156,8 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->membershipVersion = anotherMember.membershipVersion;
+	this->membershipEvents = anotherMember.membershipEvents;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
@@ -170,6 +176,8 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->membershipVersion = anotherMember.membershipVersion;
+	this->membershipEvents = anotherMember.membershipEvents;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
@@ -65,9 +65,12 @@ public:
 	short port;
 	long heartbeat;
 	long timestamp;
+	// tick this entry last changed, and the member whose gossip changed it (-1 if none did)
+	long changedAt;
+	long changedFrom;
 	MemberListEntry(int id, short port, long heartbeat, long timestamp);
 	MemberListEntry(int id, short port);
-	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0) {}
+	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0), changedAt(0), changedFrom(-1) {}
 	MemberListEntry(const MemberListEntry &anotherMLE);
 	MemberListEntry& operator =(const MemberListEntry &anotherMLE);
 	int getid();
@@ -80,6 +83,18 @@ public:
 	void settimestamp(long timestamp);
 };
 
+/**
+ * STRUCT NAME: MembershipEvent
+ *
+ * DESCRIPTION: A member joining or leaving a membership list, and the version of the list it made
+ */
+typedef struct MembershipEvent {
+	long version;
+	int id;
+	short port;
+	bool joined;
+}MembershipEvent;
+
 /**
  * CLASS NAME: Member
  *
@@ -106,6 +121,10 @@ public:
 	int timeOutCounter;
 	// Membership table
 	vector<MemberListEntry> memberList;
+	// bumped by every join and leave of memberList
+	long membershipVersion;
+	// the joins and leaves not yet taken by the ring, oldest first
+	vector<MembershipEvent> membershipEvents;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
 	// Queue for failure detection messages
@@ -115,7 +134,7 @@ public:
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), membershipVersion(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
@@ -174,3 +174,128 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->value = anotherMessage.value;
 	return *this;
 }
+
+/**
+ * FUNCTION NAME: putInt
+ *
+ * DESCRIPTION: Writes value as four bytes, low byte first
+ */
+static void putInt(char *p, unsigned int value) {
+	for ( int shift = 0; shift < 32; shift += 8 ) {
+		*p++ = (char)((value >> shift) & 0xff);
+	}
+}
+
+/**
+ * FUNCTION NAME: getInt
+ *
+ * DESCRIPTION: Reads four bytes, low byte first
+ */
+static unsigned int getInt(const char *p) {
+	unsigned int value = 0;
+	for ( int shift = 0; shift < 32; shift += 8 ) {
+		value |= (unsigned int)(unsigned char)*p++ << shift;
+	}
+	return value;
+}
+
+/**
+ * FUNCTION NAME: encodedSize
+ *
+ * DESCRIPTION: Bytes encode writes for this message
+ */
+int Message::encodedSize(){
+	return MSG_HEADER_SIZE + key.size() + value.size();
+}
+
+/**
+ * FUNCTION NAME: encode
+ *
+ * DESCRIPTION: Serializes the message into buffer as
+ * 				magic|version, type, replica, success, transID, the 6 address bytes,
+ * 				key length, value length, key, value
+ * 				with the numbers low byte first. The fields the type does not use go as 0,
+ * 				as toString leaves them out.
+ *
+ * RETURNS:
+ * bytes written, or -1 if they do not fit in capacity
+ */
+int Message::encode(char *buffer, int capacity){
+	int size = encodedSize();
+	bool hasReplica = type == CREATE || type == UPDATE;
+
+	if ( size > capacity ) {
+		return -1;
+	}
+	buffer[0] = (char)(MSG_WIRE_MAGIC | MSG_WIRE_VERSION);
+	buffer[1] = (char)type;
+	buffer[2] = (char)(hasReplica ? replica : PRIMARY);
+	buffer[3] = (char)(type == REPLY && success);
+	putInt(buffer + 4, transID);
+	memcpy(buffer + 8, fromAddr.addr, sizeof(fromAddr.addr));
+	putInt(buffer + 14, key.size());
+	putInt(buffer + 18, value.size());
+	memcpy(buffer + MSG_HEADER_SIZE, key.data(), key.size());
+	memcpy(buffer + MSG_HEADER_SIZE + key.size(), value.data(), value.size());
+	return size;
+}
+
+/**
+ * FUNCTION NAME: isBinary
+ *
+ * DESCRIPTION: Whether data is a binary message of any version, rather than a text one
+ */
+bool Message::isBinary(const char *data, int size){
+	return size >= 1 && ((unsigned char)data[0] & 0xf0) == MSG_WIRE_MAGIC;
+}
+
+/**
+ * FUNCTION NAME: decode
+ *
+ * DESCRIPTION: Decodes a binary message into view, without copying the key or the value
+ *
+ * RETURNS:
+ * false if data is not a well formed binary message of a known version
+ */
+bool Message::decode(const char *data, int size, MessageView &view){
+	if ( size < MSG_HEADER_SIZE || !isBinary(data, size) || ((unsigned char)data[0] & 0x0f) != MSG_WIRE_VERSION ) {
+		return false;
+	}
+	unsigned char type = data[1];
+	unsigned char replica = data[2];
+	unsigned int keySize = getInt(data + 14);
+	unsigned int valueSize = getInt(data + 18);
+	if ( type > READREPLY || replica > TERTIARY || keySize > (unsigned int)(size - MSG_HEADER_SIZE) ||
+			valueSize != (unsigned int)(size - MSG_HEADER_SIZE) - keySize ) {
+		return false;
+	}
+
+	view.type = static_cast<MessageType>(type);
+	view.replica = static_cast<ReplicaType>(replica);
+	view.success = data[3] != 0;
+	view.transID = (int)getInt(data + 4);
+	memcpy(view.fromAddr.addr, data + 8, sizeof(view.fromAddr.addr));
+	view.key = data + MSG_HEADER_SIZE;
+	view.keySize = keySize;
+	view.value = view.key + keySize;
+	view.valueSize = valueSize;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: toView
+ *
+ * DESCRIPTION: Points view at this message, so that a parsed text message is handled like a
+ * 				decoded binary one. The view is only valid as long as the message is.
+ */
+void Message::toView(MessageView &view){
+	view.type = type;
+	view.replica = replica;
+	view.success = success;
+	view.transID = transID;
+	view.fromAddr = fromAddr;
+	view.key = key.data();
+	view.keySize = key.size();
+	view.value = value.data();
+	view.valueSize = value.size();
+}
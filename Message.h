@@ -10,6 +10,35 @@
 #include "Member.h"
 #include "common.h"
 
+/*
+ * Macros
+ */
+// first byte of a binary message: the high nibble marks the binary format, the low one is its
+// version. A text message starts with its transID, a digit or '-'.
+#define MSG_WIRE_MAGIC 0xB0
+#define MSG_WIRE_VERSION 1
+// magic|version, type, replica, success, transID, sender address, key length, value length
+#define MSG_HEADER_SIZE 22
+
+/**
+ * STRUCT NAME: MessageView
+ *
+ * DESCRIPTION: A decoded binary message, or a parsed text one seen through toView. key and
+ * 				value point into the received bytes or the message, and are only valid as long
+ * 				as those are.
+ */
+typedef struct MessageView {
+	MessageType type;
+	ReplicaType replica;
+	bool success;
+	int transID;
+	Address fromAddr;
+	const char *key;
+	int keySize;
+	const char *value;
+	int valueSize;
+}MessageView;
+
 /**
  * CLASS NAME: Message
  *
@@ -41,6 +70,12 @@ public:
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
+	// serialize to the binary format
+	int encodedSize();
+	int encode(char *buffer, int capacity);
+	static bool isBinary(const char *data, int size);
+	static bool decode(const char *data, int size, MessageView &view);
+	void toView(MessageView &view);
 };
 
 #endif
@@ -9,7 +9,7 @@
 /**
  * Constructor
  */
-Params::Params(): PORTNUM(8001) {}
+Params::Params(): PORTNUM(8001), LATENCY(0), JITTER(0), JITTER_DIST(UNIFORM_JITTER), TRANSPORT(EMUL_TRANSPORT), UDP_PORT_BASE(20000), PROCESSES(1), THREADS(1), SEED(0), SCHEDULER(TICK_SCHEDULER), GOSSIP(ALL_GOSSIP), GOSSIP_FANOUT(1), GOSSIP_PERIOD(1), GOSSIP_DELTA(0), GOSSIP_DIGEST(0), DETECTOR(HEARTBEAT_DETECTOR), SWIM_PERIOD(6), SWIM_K(3), SWIM_SUSPECT(10), PHI_THRESHOLD(8), PHI_WINDOW(32), RING_K(2), RING_TIMEOUT(5), VIEW(FULL_VIEW), VIEW_ACTIVE(5), VIEW_PASSIVE(30), VIEW_SHUFFLE(10), VIEW_KEEPALIVE(2), VIEW_RING(1), MP2_WIRE(BINARY_WIRE) {}
 
 /**
  * FUNCTION NAME: setparams
@@ -19,6 +19,9 @@ Params::Params(): PORTNUM(8001) {}
 void Params::setparams(char *config_file) {
 	//trace.funcEntry("Params::setparams");
 	char CRUD[10];
+	char line[256];
+	char name[64];
+	int offset;
 	FILE *fp = fopen(config_file,"r");
 
 	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
@@ -51,11 +54,173 @@ void Params::setparams(char *config_file) {
 	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
+
+	// Different every run unless the test case fixes it
+	SEED = time(NULL);
+	// about log N peers per gossip round
+	GOSSIP_FANOUT = max(1, (int)ceil(log2(EN_GPSZ)));
+
+	// Optional settings follow the mandatory ones, one "NAME: value" per line
+	while ( fgets(line, sizeof(line), fp) != NULL ) {
+		offset = -1;
+		if ( sscanf(line, " %63[^: \t\n]: %n", name, &offset) >= 1 && offset >= 0 ) {
+			setoption(name, line + offset);
+		}
+	}
 	fclose(fp);
 	//trace.funcExit("Params::setparams", SUCCESS);
 	return;
 }
 
+/**
+ * FUNCTION NAME: setoption
+ *
+ * DESCRIPTION: Set one optional parameter of the test case
+ */
+void Params::setoption(char *name, char *value) {
+	if ( 0 == strcmp(name, "LATENCY") ) {
+		LATENCY = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "JITTER") ) {
+		JITTER = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "JITTER_DIST") ) {
+		if ( 0 == strncmp(value, "EXPONENTIAL", 11) ) {
+			JITTER_DIST = EXPONENTIAL_JITTER;
+		}
+		else {
+			JITTER_DIST = UNIFORM_JITTER;
+		}
+	}
+	else if ( 0 == strcmp(name, "LINK") ) {
+		// LINK: <from id> <to id> <latency> <jitter>
+		LinkDelay link;
+		if ( sscanf(value, "%d %d %d %d", &link.from, &link.to, &link.latency, &link.jitter) == 4 ) {
+			LINKS.push_back(link);
+		}
+	}
+	else if ( 0 == strcmp(name, "TRANSPORT") ) {
+		if ( 0 == strncmp(value, "UDP", 3) ) {
+			TRANSPORT = UDP_TRANSPORT;
+		}
+		else {
+			TRANSPORT = EMUL_TRANSPORT;
+		}
+	}
+	else if ( 0 == strcmp(name, "UDP_PORT_BASE") ) {
+		UDP_PORT_BASE = atoi(value);
+	}
+	else if ( 0 == strcmp(name, "THREADS") ) {
+		THREADS = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "SEED") ) {
+		SEED = strtoul(value, NULL, 10);
+	}
+	else if ( 0 == strcmp(name, "SCHEDULER") ) {
+		if ( 0 == strncmp(value, "EVENT", 5) ) {
+			SCHEDULER = EVENT_SCHEDULER;
+		}
+		else {
+			SCHEDULER = TICK_SCHEDULER;
+		}
+	}
+	else if ( 0 == strcmp(name, "GOSSIP") ) {
+		if ( 0 == strncmp(value, "FANOUT", 6) ) {
+			GOSSIP = FANOUT_GOSSIP;
+		}
+		else {
+			GOSSIP = ALL_GOSSIP;
+		}
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_FANOUT") ) {
+		GOSSIP_FANOUT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_PERIOD") ) {
+		GOSSIP_PERIOD = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_DELTA") ) {
+		GOSSIP_DELTA = max(0, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "GOSSIP_DIGEST") ) {
+		GOSSIP_DIGEST = max(0, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "DETECTOR") ) {
+		if ( 0 == strncmp(value, "SWIM", 4) ) {
+			DETECTOR = SWIM_DETECTOR;
+		}
+		else if ( 0 == strncmp(value, "PHI", 3) ) {
+			DETECTOR = PHI_DETECTOR;
+		}
+		else if ( 0 == strncmp(value, "RING", 4) ) {
+			DETECTOR = RING_DETECTOR;
+		}
+		else {
+			DETECTOR = HEARTBEAT_DETECTOR;
+		}
+	}
+	else if ( 0 == strcmp(name, "SWIM_PERIOD") ) {
+		// room for a direct and an indirect round trip
+		SWIM_PERIOD = max(3, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "SWIM_K") ) {
+		SWIM_K = max(0, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "SWIM_SUSPECT") ) {
+		SWIM_SUSPECT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "PHI_THRESHOLD") ) {
+		PHI_THRESHOLD = max(0.5, atof(value));
+	}
+	else if ( 0 == strcmp(name, "PHI_WINDOW") ) {
+		PHI_WINDOW = max(PHI_MIN_SAMPLES, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "RING_K") ) {
+		RING_K = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "RING_TIMEOUT") ) {
+		RING_TIMEOUT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "VIEW") ) {
+		if ( 0 == strncmp(value, "HYPARVIEW", 9) ) {
+			VIEW = HYPARVIEW_VIEW;
+		}
+		else {
+			VIEW = FULL_VIEW;
+		}
+	}
+	else if ( 0 == strcmp(name, "VIEW_ACTIVE") ) {
+		// a shuffle walk needs a neighbour besides the one it came from
+		VIEW_ACTIVE = max(2, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "VIEW_PASSIVE") ) {
+		VIEW_PASSIVE = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "VIEW_SHUFFLE") ) {
+		VIEW_SHUFFLE = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "VIEW_KEEPALIVE") ) {
+		VIEW_KEEPALIVE = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(name, "VIEW_RING") ) {
+		VIEW_RING = atoi(value) != 0;
+	}
+	else if ( 0 == strcmp(name, "MP2_WIRE") ) {
+		if ( 0 == strncmp(value, "TEXT", 4) ) {
+			MP2_WIRE = TEXT_WIRE;
+		}
+		else {
+			MP2_WIRE = BINARY_WIRE;
+		}
+	}
+	else if ( 0 == strcmp(name, "PROCESSES") ) {
+		// at least one node per process
+		PROCESSES = max(1, min(atoi(value), EN_GPSZ));
+	}
+	else {
+		cout<<"Ignoring unknown parameter "<<name<<endl;
+	}
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
@@ -13,6 +13,42 @@
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
 
+// how link jitter is drawn
+enum jitterTYPE { UNIFORM_JITTER, EXPONENTIAL_JITTER };
+
+// network backend carrying the messages
+enum transportTYPE { EMUL_TRANSPORT, UDP_TRANSPORT };
+enum schedulerTYPE { TICK_SCHEDULER, EVENT_SCHEDULER };
+
+// whom MP1 gossips to: every member with probability 0.6, or GOSSIP_FANOUT random members
+enum gossipTYPE { ALL_GOSSIP, FANOUT_GOSSIP };
+
+// how MP1 finds failed members: heartbeat gossip with a fixed timeout, SWIM probes,
+// heartbeat gossip judged by the phi accrual of each member's arrival history, or heartbeats
+// between ring neighbours with SWIM suspicion and piggybacked dissemination
+enum detectorTYPE { HEARTBEAT_DETECTOR, SWIM_DETECTOR, PHI_DETECTOR, RING_DETECTOR };
+// what a node keeps of the group: every member, or HyParView's small active and larger
+// passive views, with the full set for MP2's ring only as updates spread over the views
+enum viewTYPE { FULL_VIEW, HYPARVIEW_VIEW };
+// how MP2 messages travel: the binary format, or the "::" separated text kept for reading
+// captures and traces
+enum wireTYPE { BINARY_WIRE, TEXT_WIRE };
+
+// inter-arrival times the PHI detector needs before it trusts its estimate; until then TREMOVE applies
+#define PHI_MIN_SAMPLES 2
+
+/**
+ * STRUCT NAME: LinkDelay
+ *
+ * DESCRIPTION: Latency and jitter, in ticks, of the link from node id "from" to node id "to"
+ */
+typedef struct LinkDelay {
+	int from;
+	int to;
+	int latency;
+	int jitter;
+}LinkDelay;
+
 /**
  * CLASS NAME: Params
  *
@@ -32,8 +68,39 @@ public:
 	int allNodesJoined;
 	short PORTNUM;
 	int CRUDTEST;
+	int LATENCY;				// default link latency in ticks
+	int JITTER;					// default link jitter in ticks
+	int JITTER_DIST;			// distribution of the jitter
+	vector<LinkDelay> LINKS;	// per link overrides of LATENCY and JITTER
+	int TRANSPORT;				// network backend
+	int UDP_PORT_BASE;			// first loopback port of the UDP backend
+	int PROCESSES;				// worker processes of the cluster mode, 1 runs everything in this process
+	int THREADS;				// threads running the nodes of a tick
+	unsigned int SEED;			// seed of all the random numbers of a run
+	int SCHEDULER;				// visit every node every tick, or only the nodes with something due
+	int GOSSIP;					// MP1 gossip mode
+	int GOSSIP_FANOUT;			// peers per round of FANOUT gossip
+	int GOSSIP_PERIOD;			// ticks between two rounds of FANOUT gossip of a node
+	int GOSSIP_DELTA;			// gossip only changed entries, with the full list every this many ticks; 0 always sends it
+	int GOSSIP_DIGEST;			// gossip a digest first, comparing heartbeats in epochs of this many ticks; 0 sends the list
+	int DETECTOR;				// MP1 failure detector
+	int SWIM_PERIOD;			// ticks of a SWIM protocol period
+	int SWIM_K;					// helpers of an indirect SWIM probe
+	int SWIM_SUSPECT;			// ticks a SWIM suspect has to refute before it is removed
+	double PHI_THRESHOLD;		// suspicion level at which the PHI detector removes a member
+	int PHI_WINDOW;				// heartbeat inter-arrival times the PHI detector remembers per member
+	int RING_K;					// successors and predecessors on the hash ring each node of the RING detector watches
+	int RING_TIMEOUT;			// ticks without a beat after which the RING detector suspects a neighbour
+	int VIEW;					// MP1 membership view
+	int VIEW_ACTIVE;			// members of a HYPARVIEW active view
+	int VIEW_PASSIVE;			// members of a HYPARVIEW passive view
+	int VIEW_SHUFFLE;			// ticks between two HYPARVIEW shuffles of a node
+	int VIEW_KEEPALIVE;			// ticks between two keepalives to an idle HYPARVIEW active neighbour
+	int VIEW_RING;				// whether HYPARVIEW also keeps and spreads the full membership set for MP2's ring
+	int MP2_WIRE;				// format of the MP2 messages a node sends; it reads both
 	Params();
 	void setparams(char *);
+	void setoption(char *name, char *value);
 	int getcurrtime();
 };
 
@@ -0,0 +1,109 @@
+/**********************************
+ * FILE NAME: ShmNet.cpp
+ *
+ * DESCRIPTION: Shared memory network backend of the cluster mode, definition
+ **********************************/
+
+#include "ShmNet.h"
+
+/**
+ * Constructor
+ */
+ShmNet::ShmNet(Params *p, Cluster *cluster, int net): EmulNet(p) {
+	this->cluster = cluster;
+	this->net = net;
+	this->drainedTime = -1;
+	this->ringFull = 0;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Sends locally through EmulNet, or through the ring to the destination's worker
+ *
+ * RETURNS:
+ * size
+ */
+int ShmNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	int dst = addressId(toaddr);
+	int time = par->getcurrtime();
+	int to;
+
+	// Unknown ids stay in this worker's mailboxes, as they would in a single process
+	if ( dst < 1 || dst > par->EN_GPSZ || (to = cluster->owner(dst - 1)) == cluster->getWorker() ) {
+		return EmulNet::ENsend(myaddr, toaddr, data, size);
+	}
+
+	if ( dropOnSend(size) ) {
+		return 0;
+	}
+	if ( !Cluster::ringPush(cluster->ring(net, cluster->getWorker(), to), time, myaddr, toaddr, data, size) ) {
+		ringFull++;
+		return 0;
+	}
+
+	traffic.addSent(addressId(myaddr), time, size);
+
+	return size;
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Moves the messages other workers sent in earlier ticks into this EmulNet.
+ * 				The tick barrier guarantees those are all in the rings by now; messages of
+ * 				the current tick are left for the next one.
+ */
+void ShmNet::drain() {
+	int now = par->getcurrtime();
+	shm_record *rec;
+
+	if ( drainedTime == now ) {
+		return;
+	}
+	for ( int from = 0; from < cluster->getWorkers(); from++ ) {
+		if ( from == cluster->getWorker() ) {
+			continue;
+		}
+		shm_ring *r = cluster->ring(net, from, cluster->getWorker());
+		while ( (rec = Cluster::ringPeek(r)) != NULL && rec->time < now ) {
+			en_msg *em = (en_msg *)malloc(sizeof(en_msg) + rec->size);
+			int sentAt = rec->time;
+			allocCount++;
+			em->size = rec->size;
+			memcpy(em->from.addr, rec->from, sizeof(em->from.addr));
+			memcpy(em->to.addr, rec->to, sizeof(em->to.addr));
+			memcpy((char *)(em + 1), rec + 1, rec->size);
+			// The producer may reuse the space as soon as it is popped
+			Cluster::ringPop(r);
+
+			post(em, sentAt);
+		}
+	}
+	drainedTime = now;
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Takes in the other workers' messages, then receives as EmulNet does
+ *
+ * RETURN:
+ * 0
+ */
+int ShmNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	drain();
+	return EmulNet::ENrecv(myaddr, enq, t, times, queue);
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the network. Called exactly once at the end of the program.
+ */
+int ShmNet::ENcleanup() {
+	if ( ringFull > 0 ) {
+		cout<<"Worker "<<cluster->getWorker()<<" dropped "<<ringFull<<" messages on full rings"<<endl;
+	}
+	return EmulNet::ENcleanup();
+}
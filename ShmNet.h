@@ -0,0 +1,41 @@
+/**********************************
+ * FILE NAME: ShmNet.h
+ *
+ * DESCRIPTION: Shared memory network backend of the cluster mode, header file
+ **********************************/
+
+#ifndef _SHMNET_H_
+#define _SHMNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include "Cluster.h"
+
+/**
+ * CLASS NAME: ShmNet
+ *
+ * DESCRIPTION: EmulNet of one cluster worker. Messages between two nodes of the same
+ * 				worker take the usual in-memory path. Messages to a node of another
+ * 				worker go through the ring from this worker to that one, stamped with
+ * 				the tick they were sent in, and enter the receiver's EmulNet (latency
+ * 				and all) at its first ENrecv of a later tick.
+ */
+class ShmNet : public EmulNet {
+private:
+	Cluster *cluster;
+	// which of the cluster's ring sets this network uses
+	int net;
+	// last tick whose messages have been taken off the rings
+	int drainedTime;
+	// messages lost to a full ring
+	long ringFull;
+	void drain();
+public:
+	ShmNet(Params *p, Cluster *cluster, int net);
+	using EmulNet::ENsend;
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENcleanup();
+};
+
+#endif /* _SHMNET_H_ */
@@ -0,0 +1,100 @@
+/**********************************
+ * FILE NAME: ThreadPool.cpp
+ *
+ * DESCRIPTION: Fixed pool of threads running the per-node work of a phase
+ **********************************/
+
+#include "ThreadPool.h"
+
+/**
+ * Constructor
+ */
+ThreadPool::ThreadPool(int numThreads): generation(0), busy(0), stopping(false), count(0), next(0) {
+	for ( int i = 1; i < numThreads; i++ ) {
+		helpers.push_back(thread(&ThreadPool::work, this));
+	}
+}
+
+/**
+ * Destructor
+ */
+ThreadPool::~ThreadPool() {
+	{
+		unique_lock<mutex> guard(lock);
+		stopping = true;
+	}
+	started.notify_all();
+	for ( unsigned int i = 0; i < helpers.size(); i++ ) {
+		helpers[i].join();
+	}
+}
+
+/**
+ * FUNCTION NAME: claim
+ *
+ * DESCRIPTION: Runs tasks of the current phase until none are left
+ */
+void ThreadPool::claim() {
+	int k;
+	while ( (k = next.fetch_add(1)) < count ) {
+		task(k);
+	}
+}
+
+/**
+ * FUNCTION NAME: work
+ *
+ * DESCRIPTION: Main loop of a helper thread
+ */
+void ThreadPool::work() {
+	long seen = 0;
+
+	for ( ;; ) {
+		{
+			unique_lock<mutex> guard(lock);
+			started.wait(guard, [&] { return stopping || generation != seen; });
+			if ( stopping ) {
+				return;
+			}
+			seen = generation;
+		}
+
+		claim();
+
+		{
+			unique_lock<mutex> guard(lock);
+			if ( --busy == 0 ) {
+				finished.notify_one();
+			}
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Runs task(0) .. task(count - 1) across the pool and waits for all of them
+ */
+void ThreadPool::run(int count, function<void(int)> task) {
+	if ( helpers.empty() || count <= 1 ) {
+		for ( int k = 0; k < count; k++ ) {
+			task(k);
+		}
+		return;
+	}
+
+	{
+		unique_lock<mutex> guard(lock);
+		this->task = task;
+		this->count = count;
+		next = 0;
+		busy = helpers.size();
+		generation++;
+	}
+	started.notify_all();
+
+	claim();
+
+	unique_lock<mutex> guard(lock);
+	finished.wait(guard, [&] { return busy == 0; });
+}
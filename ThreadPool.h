@@ -0,0 +1,50 @@
+/**********************************
+ * FILE NAME: ThreadPool.h
+ *
+ * DESCRIPTION: Fixed pool of threads running the per-node work of a phase
+ **********************************/
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include "stdincludes.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+ * CLASS NAME: ThreadPool
+ *
+ * DESCRIPTION: numThreads - 1 helper threads plus the calling thread run the tasks
+ * 				of one phase at a time. Tasks are claimed one by one from a shared
+ * 				counter, so a thread that finishes early takes over the tasks that
+ * 				are left instead of waiting behind a slow one. run() returns once
+ * 				every task of the phase is done, which makes it the barrier between
+ * 				phases.
+ */
+class ThreadPool {
+private:
+	vector<thread> helpers;
+	mutex lock;
+	condition_variable started;
+	condition_variable finished;
+	// bumped for every phase, helpers wait for it to change
+	long generation;
+	// helpers still working on the current phase
+	int busy;
+	bool stopping;
+	// the current phase
+	function<void(int)> task;
+	int count;
+	atomic<int> next;
+	void work();
+	void claim();
+public:
+	ThreadPool(int numThreads);
+	virtual ~ThreadPool();
+	void run(int count, function<void(int)> task);
+};
+
+#endif /* _THREADPOOL_H_ */
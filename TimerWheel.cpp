@@ -0,0 +1,206 @@
+/**********************************
+ * FILE NAME: TimerWheel.cpp
+ *
+ * DESCRIPTION: Hierarchical timing wheel of per key deadlines definition
+ **********************************/
+
+#include "TimerWheel.h"
+
+/**
+ * Constructor
+ */
+TimerWheel::TimerWheel() {
+	clear();
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Drops every deadline and starts the wheel over at tick 0
+ */
+void TimerWheel::clear() {
+	pool.clear();
+	armed.clear();
+	freeList = -1;
+	now = 0;
+	for ( int i = 0; i < TIMER_LEVELS * TIMER_SLOTS; i++ ) {
+		heads[i] = -1;
+	}
+}
+
+/**
+ * FUNCTION NAME: link
+ *
+ * DESCRIPTION: Puts a node at the head of the slot its deadline falls in, as seen from now.
+ * 				A deadline before earliest goes in the slot of earliest: the next tick when it
+ * 				is armed, and the current tick when a level 1 slot is spread, since the current
+ * 				level 0 slot is drained right after.
+ */
+void TimerWheel::link(int index, int earliest) {
+	TimerNode &node = pool[index];
+	int due = max(node.due, earliest);
+	int delta = due - now;
+
+	if ( delta < TIMER_SLOTS ) {
+		node.slot = due & (TIMER_SLOTS - 1);
+	}
+	else if ( delta < TIMER_SLOTS * TIMER_SLOTS ) {
+		node.slot = TIMER_SLOTS + ((due >> TIMER_BITS) & (TIMER_SLOTS - 1));
+	}
+	else {
+		// beyond the last level, wait in the slot reached last
+		node.slot = TIMER_SLOTS + (((now >> TIMER_BITS) - 1) & (TIMER_SLOTS - 1));
+	}
+
+	node.prev = -1;
+	node.next = heads[node.slot];
+	if ( node.next >= 0 ) {
+		pool[node.next].prev = index;
+	}
+	heads[node.slot] = index;
+}
+
+/**
+ * FUNCTION NAME: unlink
+ *
+ * DESCRIPTION: Takes a node out of the list of its slot
+ */
+void TimerWheel::unlink(int index) {
+	TimerNode &node = pool[index];
+
+	if ( node.prev >= 0 ) {
+		pool[node.prev].next = node.next;
+	}
+	else {
+		heads[node.slot] = node.next;
+	}
+	if ( node.next >= 0 ) {
+		pool[node.next].prev = node.prev;
+	}
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Arms the deadline of key for tick due, replacing the one it had
+ */
+void TimerWheel::schedule(long key, int due) {
+	unordered_map<long, int>::iterator it = armed.find(key);
+	int index;
+
+	if ( it != armed.end() ) {
+		index = it->second;
+		if ( pool[index].due == due ) {
+			return;
+		}
+		unlink(index);
+	}
+	else {
+		if ( freeList >= 0 ) {
+			index = freeList;
+			freeList = pool[index].next;
+		}
+		else {
+			index = pool.size();
+			pool.push_back(TimerNode());
+		}
+		pool[index].key = key;
+		armed[key] = index;
+	}
+	pool[index].due = due;
+	link(index, now + 1);
+}
+
+/**
+ * FUNCTION NAME: cancel
+ *
+ * DESCRIPTION: Disarms the deadline of key, if it has one
+ */
+void TimerWheel::cancel(long key) {
+	unordered_map<long, int>::iterator it = armed.find(key);
+
+	if ( it == armed.end() ) {
+		return;
+	}
+	int index = it->second;
+	unlink(index);
+	armed.erase(it);
+	pool[index].next = freeList;
+	freeList = index;
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Moves the wheel up to tick time and appends the keys whose deadline came due
+ * 				on the way to expired. Their deadlines are disarmed.
+ */
+void TimerWheel::advance(int time, vector<long> &expired) {
+	while ( now < time ) {
+		now++;
+
+		if ( (now & (TIMER_SLOTS - 1)) == 0 ) {
+			// entering a new level 1 slot, spread its nodes over level 0
+			int slot = TIMER_SLOTS + ((now >> TIMER_BITS) & (TIMER_SLOTS - 1));
+			int index = heads[slot];
+			heads[slot] = -1;
+			while ( index >= 0 ) {
+				int next = pool[index].next;
+				link(index, now);
+				index = next;
+			}
+		}
+
+		int index = heads[now & (TIMER_SLOTS - 1)];
+		while ( index >= 0 ) {
+			int next = pool[index].next;
+			if ( pool[index].due <= now ) {
+				expired.push_back(pool[index].key);
+				cancel(pool[index].key);
+			}
+			index = next;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: nextDue
+ *
+ * DESCRIPTION: First tick by which advance has to run for no deadline to be missed. A level 0
+ * 				slot only holds the deadlines of one tick, or the passed ones in the next
+ * 				tick's slot, so the first non-empty one ahead gives its tick. A level 1 slot
+ * 				is spread over level 0 on the tick the wheel enters it, which bounds the ticks
+ * 				of the deadlines it holds. The cost is bounded by the slot count, whatever the
+ * 				number of deadlines.
+ *
+ * RETURNS:
+ * the tick, or INT_MAX if no deadline is armed
+ */
+int TimerWheel::nextDue() {
+	int next = INT_MAX;
+	int t;
+
+	for ( t = now + 1; t < now + TIMER_SLOTS; t++ ) {
+		if ( heads[t & (TIMER_SLOTS - 1)] >= 0 ) {
+			next = t;
+			break;
+		}
+	}
+	// deadlines a whole level 1 turn away wrap onto the current level 1 slot
+	for ( t = (now >> TIMER_BITS) + 1; t <= (now >> TIMER_BITS) + TIMER_SLOTS; t++ ) {
+		if ( heads[TIMER_SLOTS + (t & (TIMER_SLOTS - 1))] >= 0 ) {
+			next = min(next, t << TIMER_BITS);
+			break;
+		}
+	}
+	return next;
+}
+
+/**
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Number of armed deadlines
+ */
+int TimerWheel::size() {
+	return armed.size();
+}
@@ -0,0 +1,69 @@
+/**********************************
+ * FILE NAME: TimerWheel.h
+ *
+ * DESCRIPTION: Hierarchical timing wheel of per key deadlines header file
+ **********************************/
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include "stdincludes.h"
+#include <unordered_map>
+#include <climits>
+
+/*
+ * Macros
+ */
+// slots of each level, a power of two; level 0 slots are one tick wide,
+// level 1 slots TIMER_SLOTS ticks
+#define TIMER_BITS 6
+#define TIMER_SLOTS (1 << TIMER_BITS)
+#define TIMER_LEVELS 2
+
+/**
+ * STRUCT NAME: TimerNode
+ *
+ * DESCRIPTION: One armed deadline, linked into the list of its slot by pool index
+ */
+typedef struct TimerNode {
+	long key;
+	int due;
+	int prev;
+	int next;
+	// level * TIMER_SLOTS + slot the node is linked into
+	int slot;
+}TimerNode;
+
+/**
+ * CLASS NAME: TimerWheel
+ *
+ * DESCRIPTION: Holds at most one deadline per key. Deadlines within TIMER_SLOTS ticks sit in
+ * 				level 0, one slot per tick. Later ones sit in level 1, one slot per TIMER_SLOTS
+ * 				ticks, and move down to level 0 when the wheel reaches their slot; deadlines
+ * 				past the end of level 1 wait in its last slot and are placed again from there.
+ * 				The slots are doubly linked lists through a pool of nodes, so arming, moving
+ * 				and cancelling a deadline take constant time, and advancing one tick only
+ * 				touches the deadlines that come due.
+ */
+class TimerWheel {
+private:
+	vector<TimerNode> pool;
+	int freeList;
+	int heads[TIMER_LEVELS * TIMER_SLOTS];
+	// pool index of the deadline of each key
+	unordered_map<long, int> armed;
+	// last tick advanced to
+	int now;
+	void link(int index, int earliest);
+	void unlink(int index);
+public:
+	TimerWheel();
+	void schedule(long key, int due);
+	void cancel(long key);
+	void advance(int time, vector<long> &expired);
+	int nextDue();
+	void clear();
+	int size();
+};
+
+#endif /* _TIMERWHEEL_H_ */
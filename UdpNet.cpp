@@ -0,0 +1,233 @@
+/**********************************
+ * FILE NAME: UdpNet.cpp
+ *
+ * DESCRIPTION: Loopback UDP network backend definition
+ **********************************/
+
+#include "UdpNet.h"
+
+/**
+ * Constructor
+ *
+ * The sockets of ids 1..EN_GPSZ are opened up front, so that a message is never
+ * sent to a node whose port is not bound yet.
+ */
+UdpNet::UdpNet(Params *p, int portBase): EmulNet(p) {
+	this->portBase = portBase;
+	this->pendingFd = -1;
+	for ( int i = 0; i < UDP_BATCH; i++ ) {
+		recvBuff[i] = newBuffer();
+	}
+	for ( int id = 1; id <= p->EN_GPSZ; id++ ) {
+		socketFor(id);
+	}
+}
+
+/**
+ * Destructor
+ */
+UdpNet::~UdpNet() {
+	for ( unsigned int i = 0; i < fds.size(); i++ ) {
+		if ( fds[i] != -1 ) {
+			close(fds[i]);
+		}
+	}
+	for ( int i = 0; i < UDP_BATCH; i++ ) {
+		free(recvBuff[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: newBuffer
+ *
+ * DESCRIPTION: Allocates a receive buffer large enough for any message
+ */
+en_msg *UdpNet::newBuffer() {
+	allocCount++;
+	return (en_msg *)malloc(sizeof(en_msg) + par->MAX_MSG_SIZE);
+}
+
+/**
+ * FUNCTION NAME: socketFor
+ *
+ * DESCRIPTION: Returns the socket of node id, binding it to 127.0.0.1:portBase+id on first use
+ */
+int UdpNet::socketFor(int id) {
+	struct sockaddr_in addr;
+	int rcvbuf = UDP_RCVBUF;
+	int fd;
+
+	assert(id >= 0 && portBase + id <= 65535);
+	if ( id >= (int)fds.size() ) {
+		fds.resize(id + 1, -1);
+	}
+	if ( fds[id] != -1 ) {
+		return fds[id];
+	}
+
+	fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+	if ( fd < 0 ) {
+		perror("UdpNet socket");
+		exit(1);
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(portBase + id);
+	if ( bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ) {
+		perror("UdpNet bind");
+		exit(1);
+	}
+
+	fds[id] = fd;
+	return fd;
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Sends the pending datagrams with sendmmsg. Datagrams the kernel
+ * 				does not take are lost, as they would be on a real network.
+ */
+void UdpNet::flush() {
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iovecs[UDP_BATCH];
+	struct sockaddr_in to[UDP_BATCH];
+	int count = pendingSize.size();
+	int sent = 0;
+	int ret;
+
+	if ( count == 0 ) {
+		return;
+	}
+
+	memset(msgs, 0, sizeof(msgs));
+	memset(to, 0, sizeof(to));
+	for ( int i = 0; i < count; i++ ) {
+		to[i].sin_family = AF_INET;
+		to[i].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		to[i].sin_port = htons(portBase + pendingDst[i]);
+		iovecs[i].iov_base = &pendingData[pendingOffset[i]];
+		iovecs[i].iov_len = pendingSize[i];
+		msgs[i].msg_hdr.msg_name = &to[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(to[i]);
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while ( sent < count ) {
+		ret = sendmmsg(pendingFd, msgs + sent, count - sent, 0);
+		if ( ret <= 0 ) {
+			break;
+		}
+		sent += ret;
+	}
+
+	pendingData.clear();
+	pendingOffset.clear();
+	pendingSize.clear();
+	pendingDst.clear();
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Queues a datagram from myaddr's socket to toaddr's port
+ *
+ * RETURNS:
+ * size
+ */
+int UdpNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	int src = addressId(myaddr);
+	int fd;
+
+	if ( dropOnSend(size) ) {
+		return 0;
+	}
+
+	fd = socketFor(src);
+	if ( fd != pendingFd || (int)pendingSize.size() >= UDP_BATCH ) {
+		flush();
+		pendingFd = fd;
+	}
+	pendingOffset.push_back(pendingData.size());
+	pendingSize.push_back(size);
+	pendingDst.push_back(addressId(toaddr));
+	pendingData.insert(pendingData.end(), data, data + size);
+
+	traffic.addSent(src, par->getcurrtime(), size);
+
+	return size;
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Flushes the pending sends and drains myaddr's socket.
+ * 				Each datagram is received straight into an en_msg buffer whose
+ * 				payload is handed to enq; release it with ENrelease.
+ *
+ * RETURN:
+ * 0
+ */
+int UdpNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iovecs[UDP_BATCH];
+	struct sockaddr_in from[UDP_BATCH];
+	int dst = addressId(myaddr);
+	int fd = socketFor(dst);
+	int received;
+	int i;
+
+	flush();
+
+	do {
+		memset(msgs, 0, sizeof(msgs));
+		for ( i = 0; i < UDP_BATCH; i++ ) {
+			iovecs[i].iov_base = (char *)(recvBuff[i] + 1);
+			iovecs[i].iov_len = par->MAX_MSG_SIZE;
+			msgs[i].msg_hdr.msg_name = &from[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		received = recvmmsg(fd, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+		for ( i = 0; i < received; i++ ) {
+			en_msg *em = recvBuff[i];
+			int src = ntohs(from[i].sin_port) - portBase;
+
+			em->size = msgs[i].msg_len;
+			memset(em->from.addr, 0, sizeof(em->from.addr));
+			memcpy(&em->from.addr[0], &src, sizeof(int));
+			memcpy(em->to.addr, myaddr->addr, sizeof(em->to.addr));
+
+			// The queue owns this buffer now, take a fresh one for the next batch
+			recvBuff[i] = newBuffer();
+			deliverCount++;
+			traffic.addRecv(dst, par->getcurrtime(), em->size);
+
+			(*enq)(queue, (char *)(em + 1), em->size);
+		}
+	} while ( received == UDP_BATCH );
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Closes the sockets and writes the message counts. Called exactly once at the end of the program.
+ */
+int UdpNet::ENcleanup() {
+	flush();
+	for ( unsigned int i = 0; i < fds.size(); i++ ) {
+		if ( fds[i] != -1 ) {
+			close(fds[i]);
+			fds[i] = -1;
+		}
+	}
+	return EmulNet::ENcleanup();
+}
@@ -0,0 +1,58 @@
+/**********************************
+ * FILE NAME: UdpNet.h
+ *
+ * DESCRIPTION: Loopback UDP network backend header file
+ **********************************/
+
+#ifndef _UDPNET_H_
+#define _UDPNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/*
+ * Macros
+ */
+// datagrams per sendmmsg / recvmmsg call
+#define UDP_BATCH 64
+// receive buffer asked for on every socket
+#define UDP_RCVBUF (1 << 20)
+
+/**
+ * CLASS NAME: UdpNet
+ *
+ * DESCRIPTION: Runs the EmulNet contract over real UDP sockets on 127.0.0.1.
+ * 				The node with id i owns the socket bound to port portBase + i,
+ * 				so the sender of a datagram is known from its source port.
+ * 				Sends are batched per source socket and flushed with sendmmsg;
+ * 				a receive drains the node's socket with non-blocking recvmmsg.
+ */
+class UdpNet : public EmulNet {
+private:
+	int portBase;
+	// fds[id] is the socket of the node with that id, -1 until it is opened
+	vector<int> fds;
+	// sends waiting for the next sendmmsg, all from the socket pendingFd
+	int pendingFd;
+	vector<char> pendingData;
+	vector<int> pendingOffset;
+	vector<int> pendingSize;
+	vector<int> pendingDst;
+	// receive buffers, each an en_msg followed by MAX_MSG_SIZE bytes
+	en_msg *recvBuff[UDP_BATCH];
+	en_msg *newBuffer();
+	int socketFor(int id);
+	void flush();
+public:
+	UdpNet(Params *p, int portBase);
+	virtual ~UdpNet();
+	using EmulNet::ENsend;
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENcleanup();
+};
+
+#endif /* _UDPNET_H_ */